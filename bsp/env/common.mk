@@ -24,6 +24,16 @@ INCLUDES += -I$(PLATFORM_DIR)
 
 TOOL_DIR = $(BSP_BASE)/../toolchain/bin
 
+# ENABLE_SMP builds get a stack and a TLS block for each of SMP_HARTS
+# harts, see start.S. Harts with a higher mhartid are parked. The
+# symbols have to be defined before the linker script is read.
+ifneq ($(filter -DENABLE_SMP,$(CFLAGS)),)
+SMP_HARTS ?= 4
+HART_STACK_SIZE ?= 1024
+LDFLAGS += -Wl,--defsym=__smp_harts=$(SMP_HARTS)
+LDFLAGS += -Wl,--defsym=__hart_stack_size=$(HART_STACK_SIZE)
+endif
+
 LDFLAGS += -T $(LINKER_SCRIPT) -nostartfiles
 LDFLAGS += -L$(ENV_DIR) --specs=nano.specs
 
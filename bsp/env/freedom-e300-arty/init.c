@@ -65,7 +65,13 @@ uintptr_t handle_trap(uintptr_t mcause, uintptr_t epc)
 #endif
   }
   else {
+    uart_flush();
     write(1, "Unhandled Trap:\n", 16);
+    write(1, "mcause ", 7);
+    write_hex(1, mcause);
+    write(1, " mepc ", 6);
+    write_hex(1, epc);
+    write(1, "\n", 1);
     _exit(1 + mcause);
   }
   return epc;
@@ -4,6 +4,7 @@
 #define _SIFIVE_HIFIVE1_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /****************************************************************************
  * GPIO Connections
@@ -77,5 +78,13 @@
 #define RTC_FREQ 32768
 
 void write_hex(int fd, unsigned long int hex);
+void write_udec(int fd, unsigned long int dec);
+void write_dec(int fd, long int dec);
+size_t fmt_hex(char *buf, unsigned long v, int digits);
+size_t fmt_udec(char *buf, unsigned long v, int width);
+size_t fmt_dec(char *buf, long v, int width);
+size_t uart_write(const void *ptr, size_t len, int crlf, int blocking);
+void uart_flush(void);
+void uart_setvbuf(char *buf, int mode, size_t size);
 
 #endif /* _SIFIVE_HIFIVE1_H */
@@ -0,0 +1,283 @@
+// See LICENSE for license details.
+#ifndef SIFIVE_ATOMIC_H
+#define SIFIVE_ATOMIC_H
+
+#include <stdint.h>
+
+/* Atomics on top of the A extension.
+ *
+ * Every operation takes an explicit memory order, which picks the
+ * cheapest RISC-V form for it:
+ *
+ *                 load                  store            AMO / LR/SC
+ * MO_RELAXED      lw                    sw               amo<op>.w
+ * MO_ACQUIRE      lw; fence r,rw        -                amo<op>.w.aq
+ * MO_RELEASE      -                     fence rw,w; sw   amo<op>.w.rl
+ * MO_ACQ_REL      -                     -                amo<op>.w.aqrl
+ * MO_SEQ_CST      fence rw,rw; lw;      fence rw,w; sw   amo<op>.w.aqrl
+ *                 fence r,rw
+ *
+ * Read-modify-write operations map onto a single AMO where the ISA has
+ * one (swap, add, and, or, xor, min, max, minu, maxu). Compare-exchange
+ * is an LR/SC loop. The order is meant to be a constant so the switch
+ * in every helper folds away.
+ *
+ * atomic64_* on RV64 are the .d forms of the above. RV32 has no 64-bit
+ * LR/SC, there they are out of line (libwrap/misc/atomic64.c) and
+ * serialized by a small table of spin locks hashed on the address.
+ * Those are always sequentially consistent and the order argument is
+ * ignored.
+ */
+
+typedef enum {
+  MO_RELAXED,
+  MO_ACQUIRE,
+  MO_RELEASE,
+  MO_ACQ_REL,
+  MO_SEQ_CST
+} memorder_t;
+
+static inline void atomic_fence(memorder_t mo)
+{
+  switch (mo) {
+  case MO_RELAXED:
+    __asm__ __volatile__ ("" ::: "memory");
+    break;
+  case MO_ACQUIRE:
+    __asm__ __volatile__ ("fence r,rw" ::: "memory");
+    break;
+  case MO_RELEASE:
+    __asm__ __volatile__ ("fence rw,w" ::: "memory");
+    break;
+  default:
+    __asm__ __volatile__ ("fence rw,rw" ::: "memory");
+    break;
+  }
+}
+
+#define _ATOMIC_AMO(insn, sfx, old, p, v)                     \
+  __asm__ __volatile__ (                                      \
+    insn sfx " %0, %2, %1"                                    \
+    : "=r" (old), "+A" (*(p))                                 \
+    : "r" (v)                                                 \
+    : "memory")
+
+#define _ATOMIC_AMO_ORDERED(insn, old, p, v, mo)              \
+  do {                                                        \
+    switch (mo) {                                             \
+    case MO_RELAXED: _ATOMIC_AMO(insn, "", old, p, v); break; \
+    case MO_ACQUIRE: _ATOMIC_AMO(insn, ".aq", old, p, v); break; \
+    case MO_RELEASE: _ATOMIC_AMO(insn, ".rl", old, p, v); break; \
+    default:         _ATOMIC_AMO(insn, ".aqrl", old, p, v); break; \
+    }                                                         \
+  } while (0)
+
+/* lr with .aq for acquire and stronger, sc with .rl for release and
+ * stronger; the seq_cst form is lr.aqrl/sc.rl. lr.w sign-extends on
+ * RV64, so exp has to be passed sign-extended as well. */
+#define _ATOMIC_CAS(w, lsfx, ssfx, old, p, exp, des)          \
+  do {                                                        \
+    uintptr_t _fail;                                          \
+    __asm__ __volatile__ (                                    \
+      "1: lr." w lsfx " %0, %2\n"                             \
+      "   bne %0, %3, 2f\n"                                   \
+      "   sc." w ssfx " %1, %4, %2\n"                         \
+      "   bnez %1, 1b\n"                                      \
+      "2:"                                                    \
+      : "=&r" (old), "=&r" (_fail), "+A" (*(p))               \
+      : "r" (exp), "r" (des)                                  \
+      : "memory");                                            \
+  } while (0)
+
+#define _ATOMIC_CAS_ORDERED(w, old, p, exp, des, mo)          \
+  do {                                                        \
+    switch (mo) {                                             \
+    case MO_RELAXED: _ATOMIC_CAS(w, "", "", old, p, exp, des); break; \
+    case MO_ACQUIRE: _ATOMIC_CAS(w, ".aq", "", old, p, exp, des); break; \
+    case MO_RELEASE: _ATOMIC_CAS(w, "", ".rl", old, p, exp, des); break; \
+    case MO_ACQ_REL: _ATOMIC_CAS(w, ".aq", ".rl", old, p, exp, des); break; \
+    default:         _ATOMIC_CAS(w, ".aqrl", ".rl", old, p, exp, des); break; \
+    }                                                         \
+  } while (0)
+
+#define _ATOMIC_LOAD(type, p, mo)                             \
+  ({                                                          \
+    type _v;                                                  \
+    if ((mo) == MO_SEQ_CST)                                   \
+      atomic_fence(MO_SEQ_CST);                               \
+    _v = *(p);                                                \
+    if ((mo) != MO_RELAXED)                                   \
+      atomic_fence(MO_ACQUIRE);                               \
+    _v;                                                       \
+  })
+
+#define _ATOMIC_STORE(p, v, mo)                               \
+  do {                                                        \
+    if ((mo) != MO_RELAXED)                                   \
+      atomic_fence(MO_RELEASE);                               \
+    *(p) = (v);                                               \
+  } while (0)
+
+#define _ATOMIC_DEFINE_RMW(pfx, w, name, insn, type)          \
+static inline type pfx##_fetch_##name(volatile type *p, type v, \
+                                      memorder_t mo)          \
+{                                                             \
+  type old;                                                   \
+  _ATOMIC_AMO_ORDERED(insn "." w, old, p, v, mo);             \
+  return old;                                                 \
+}
+
+#define _ATOMIC_DEFINE(pfx, w, type, stype)                   \
+static inline type pfx##_load(const volatile type *p, memorder_t mo) \
+{                                                             \
+  return _ATOMIC_LOAD(type, p, mo);                           \
+}                                                             \
+                                                              \
+static inline void pfx##_store(volatile type *p, type v, memorder_t mo) \
+{                                                             \
+  _ATOMIC_STORE(p, v, mo);                                    \
+}                                                             \
+                                                              \
+static inline type pfx##_exchange(volatile type *p, type v, memorder_t mo) \
+{                                                             \
+  type old;                                                   \
+  _ATOMIC_AMO_ORDERED("amoswap." w, old, p, v, mo);           \
+  return old;                                                 \
+}                                                             \
+                                                              \
+/* on failure *expected is updated to the value found */     \
+static inline int pfx##_cas(volatile type *p, type *expected, type desired, \
+                            memorder_t mo)                    \
+{                                                             \
+  type old, exp = *expected;                                  \
+  long sexp = (long)(stype)exp;                               \
+  _ATOMIC_CAS_ORDERED(w, old, p, sexp, desired, mo);          \
+  *expected = old;                                            \
+  return old == exp;                                          \
+}                                                             \
+                                                              \
+_ATOMIC_DEFINE_RMW(pfx, w, add, "amoadd", type)               \
+_ATOMIC_DEFINE_RMW(pfx, w, and, "amoand", type)               \
+_ATOMIC_DEFINE_RMW(pfx, w, or, "amoor", type)                 \
+_ATOMIC_DEFINE_RMW(pfx, w, xor, "amoxor", type)               \
+_ATOMIC_DEFINE_RMW(pfx, w, minu, "amominu", type)             \
+_ATOMIC_DEFINE_RMW(pfx, w, maxu, "amomaxu", type)             \
+                                                              \
+static inline type pfx##_fetch_sub(volatile type *p, type v, memorder_t mo) \
+{                                                             \
+  return pfx##_fetch_add(p, -v, mo);                          \
+}                                                             \
+                                                              \
+static inline stype pfx##_fetch_min(volatile stype *p, stype v, memorder_t mo) \
+{                                                             \
+  stype old;                                                  \
+  _ATOMIC_AMO_ORDERED("amomin." w, old, p, v, mo);            \
+  return old;                                                 \
+}                                                             \
+                                                              \
+static inline stype pfx##_fetch_max(volatile stype *p, stype v, memorder_t mo) \
+{                                                             \
+  stype old;                                                  \
+  _ATOMIC_AMO_ORDERED("amomax." w, old, p, v, mo);            \
+  return old;                                                 \
+}
+
+_ATOMIC_DEFINE(atomic32, "w", uint32_t, int32_t)
+
+#if __riscv_xlen == 64
+
+_ATOMIC_DEFINE(atomic64, "d", uint64_t, int64_t)
+
+#define ATOMIC_PTR_W "d"
+
+#else
+
+/* the order argument is accepted for symmetry and ignored */
+uint64_t atomic64_load(const volatile uint64_t *p, memorder_t mo);
+void atomic64_store(volatile uint64_t *p, uint64_t v, memorder_t mo);
+uint64_t atomic64_exchange(volatile uint64_t *p, uint64_t v, memorder_t mo);
+int atomic64_cas(volatile uint64_t *p, uint64_t *expected, uint64_t desired,
+                 memorder_t mo);
+uint64_t atomic64_fetch_add(volatile uint64_t *p, uint64_t v, memorder_t mo);
+uint64_t atomic64_fetch_sub(volatile uint64_t *p, uint64_t v, memorder_t mo);
+uint64_t atomic64_fetch_and(volatile uint64_t *p, uint64_t v, memorder_t mo);
+uint64_t atomic64_fetch_or(volatile uint64_t *p, uint64_t v, memorder_t mo);
+uint64_t atomic64_fetch_xor(volatile uint64_t *p, uint64_t v, memorder_t mo);
+uint64_t atomic64_fetch_minu(volatile uint64_t *p, uint64_t v, memorder_t mo);
+uint64_t atomic64_fetch_maxu(volatile uint64_t *p, uint64_t v, memorder_t mo);
+int64_t atomic64_fetch_min(volatile int64_t *p, int64_t v, memorder_t mo);
+int64_t atomic64_fetch_max(volatile int64_t *p, int64_t v, memorder_t mo);
+
+#define ATOMIC_PTR_W "w"
+
+#endif
+
+/* Pointer sized, for lock-free lists and queues */
+
+static inline void *atomicptr_load(void *const volatile *p, memorder_t mo)
+{
+  return _ATOMIC_LOAD(void *, p, mo);
+}
+
+static inline void atomicptr_store(void *volatile *p, void *v, memorder_t mo)
+{
+  _ATOMIC_STORE(p, v, mo);
+}
+
+static inline void *atomicptr_exchange(void *volatile *p, void *v,
+                                       memorder_t mo)
+{
+  void *old;
+  _ATOMIC_AMO_ORDERED("amoswap." ATOMIC_PTR_W, old, p, v, mo);
+  return old;
+}
+
+static inline int atomicptr_cas(void *volatile *p, void **expected,
+                                void *desired, memorder_t mo)
+{
+  void *old, *exp = *expected;
+  long sexp = (long)exp;
+  _ATOMIC_CAS_ORDERED(ATOMIC_PTR_W, old, p, sexp, desired, mo);
+  *expected = old;
+  return old == exp;
+}
+
+/* Compatibility with the atomic_t the SMP example started out with */
+
+#define ATOMIC_INIT(x)		\
+	{			\
+		.counter = (x),	\
+	}
+
+typedef struct {
+  volatile int counter;
+} atomic_t;
+
+static inline int atomic_read(atomic_t *v)
+{
+  return (int)atomic32_load((volatile uint32_t *)&v->counter, MO_RELAXED);
+}
+
+static inline void atomic_set(atomic_t *v, int n)
+{
+  atomic32_store((volatile uint32_t *)&v->counter, n, MO_RELAXED);
+}
+
+static inline int atomic_add_return(atomic_t *v, int n)
+{
+  return (int)atomic32_fetch_add((volatile uint32_t *)&v->counter, n,
+                                 MO_SEQ_CST) + n;
+}
+
+static inline int atomic_xchg(atomic_t *v, int n)
+{
+  return (int)atomic32_exchange((volatile uint32_t *)&v->counter, n,
+                                MO_SEQ_CST);
+}
+
+static inline void mb(void)
+{
+  atomic_fence(MO_SEQ_CST);
+}
+
+#endif
@@ -0,0 +1,143 @@
+// See LICENSE for license details.
+#ifndef SIFIVE_BENCH_H
+#define SIFIVE_BENCH_H
+
+#include <stdint.h>
+#include "encoding.h"
+
+/* Microbenchmark harness with JSON-lines results.
+ *
+ * BENCH() defines a benchmark and registers it from a constructor,
+ * bench_run_all() runs the registered ones in link order. Each gets
+ * warmup untimed calls of its body, then reps calls with mcycle and
+ * minstret read around every one:
+ *
+ *   BENCH(memset_1k, .reps = 8, .ops = 1024, .unit = "byte")
+ *   {
+ *     memset(buf, 0, sizeof(buf));
+ *   }
+ *
+ * A body leaves setup out of the measurement with bench_pause() and
+ * bench_resume(), replaces the measured cycles with bench_set_cycles()
+ * when it timestamps an event itself, and gives up with bench_skip()
+ * when the board lacks what it measures. The cost of an empty body is
+ * subtracted from every run.
+ *
+ * Each benchmark prints one line to stdout, e.g.
+ *
+ *   {"bench":"memset_1k","reps":8,"ops":1024,"unit":"byte",
+ *   "cycles_min":2190,"cycles_med":2193,"cycles_max":2410,
+ *   "instret":1541,"cycles_per_op":2.138}
+ *
+ * without the line breaks. Whole programs such as CoreMark print their
+ * results in the same format with bench_record_*(). bench_end() prints
+ * the {"bench":"_end"} record that bsp/tools/bench_run.py waits for.
+ */
+
+#ifndef BENCH_MAX_REPS
+#define BENCH_MAX_REPS 32
+#endif
+
+#define BENCH_WARMUP 1
+#define BENCH_REPS 5
+
+typedef struct bench {
+  const char *name;
+  void (*fn)(struct bench *b);
+  uint32_t warmup;
+  uint32_t reps;
+  uint32_t ops;           /* units of work done by one call of fn */
+  const char *unit;
+  struct bench *next;
+
+  /* the run in progress */
+  uint64_t cycles, instret;
+  uint64_t start_cycles, start_instret;
+  uint64_t set_cycles;
+  int cycles_set;
+  int skipped;
+} bench_t;
+
+void bench_register(bench_t *b);
+
+#define BENCH(id, ...)                                                \
+  static void bench_fn_##id(bench_t *b);                              \
+  static bench_t bench_##id = {                                       \
+    .name = #id, .fn = bench_fn_##id, .warmup = BENCH_WARMUP,         \
+    .reps = BENCH_REPS, .ops = 1, .unit = "op", ##__VA_ARGS__         \
+  };                                                                  \
+  static void __attribute__((constructor)) bench_reg_##id(void)       \
+  {                                                                   \
+    bench_register(&bench_##id);                                      \
+  }                                                                   \
+  static void bench_fn_##id(bench_t *b)
+
+static inline uint64_t bench_cycles(void)
+{
+#if __riscv_xlen == 32
+  while (1) {
+    uint32_t hi = read_csr(mcycleh);
+    uint32_t lo = read_csr(mcycle);
+    if (hi == read_csr(mcycleh))
+      return ((uint64_t)hi << 32) | lo;
+  }
+#else
+  return read_csr(mcycle);
+#endif
+}
+
+static inline uint64_t bench_instret(void)
+{
+#if __riscv_xlen == 32
+  while (1) {
+    uint32_t hi = read_csr(minstreth);
+    uint32_t lo = read_csr(minstret);
+    if (hi == read_csr(minstreth))
+      return ((uint64_t)hi << 32) | lo;
+  }
+#else
+  return read_csr(minstret);
+#endif
+}
+
+static inline void bench_resume(bench_t *b)
+{
+  b->start_instret = bench_instret();
+  b->start_cycles = bench_cycles();
+}
+
+static inline void bench_pause(bench_t *b)
+{
+  uint64_t c = bench_cycles();
+  uint64_t i = bench_instret();
+
+  b->cycles += c - b->start_cycles;
+  b->instret += i - b->start_instret;
+}
+
+static inline void bench_set_cycles(bench_t *b, uint64_t cycles)
+{
+  b->cycles_set = 1;
+  b->set_cycles = cycles;
+}
+
+static inline void bench_skip(bench_t *b)
+{
+  b->skipped = 1;
+}
+
+/* Runs every registered benchmark, returns how many reported */
+int bench_run_all(void);
+
+/* One JSON object per line, fields in call order. Keys and string
+ * values are printed as they are. */
+void bench_record_begin(const char *name);
+void bench_record_u64(const char *key, uint64_t v);
+void bench_record_str(const char *key, const char *v);
+/* v in units of 10^-decimals, printed as a JSON number */
+void bench_record_fixed(const char *key, uint64_t v, int decimals);
+void bench_record_end(void);
+
+void bench_end(void);
+
+#endif
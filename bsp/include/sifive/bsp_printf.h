@@ -0,0 +1,31 @@
+// See LICENSE for license details.
+#ifndef _SIFIVE_BSP_PRINTF_H
+#define _SIFIVE_BSP_PRINTF_H
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/* Small printf family from libwrap (misc/bsp_printf.c). It never
+ * allocates and uses a fixed ~150 byte stack frame. bsp_printf() writes
+ * to stdout in 32 byte chunks through write(). The snprintf variants
+ * return the untruncated length like the C library ones.
+ *
+ * Supported: %d %i %u %x %X %o %c %s %p %%, the flags - 0 + space and #,
+ * width, precision, '*', and the length modifiers hh h l ll z. %f is
+ * only formatted when libwrap is built with BSP_PRINTF_FLOAT (printed
+ * as "?" otherwise) and goes through 64 bit fixed point, so up to 9
+ * fraction digits and magnitudes below 2^64 are printed, with halves
+ * rounded up.
+ *
+ * In ENABLE_SMP builds printf() and vprintf() are wrapped to
+ * bsp_vprintf(), newlib's stdout is not safe to share between harts.
+ */
+
+int bsp_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+int bsp_vprintf(const char *fmt, va_list ap) __attribute__((format(printf, 1, 0)));
+int bsp_snprintf(char *buf, size_t size, const char *fmt, ...)
+  __attribute__((format(printf, 3, 4)));
+int bsp_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap)
+  __attribute__((format(printf, 3, 0)));
+
+#endif /* _SIFIVE_BSP_PRINTF_H */
@@ -0,0 +1,100 @@
+// See LICENSE for license details.
+#ifndef SIFIVE_HARTQ_H
+#define SIFIVE_HARTQ_H
+
+#include <stdint.h>
+#include "platform.h"
+#include "sifive/atomic.h"
+
+/* Single-producer single-consumer message rings between two harts.
+ *
+ * One hartq_t carries word-sized messages (values or pointers) from one
+ * hart to another, declare one per direction and pair that needs it:
+ *
+ *   hartq_t to_logger = HARTQ_INIT(1);
+ *
+ *   hart 0:  while (!hartq_send(&to_logger, (uintptr_t)msg)) ;
+ *   hart 1:  hartq_sleep(qs, 1); hartq_recv(&to_logger, &msg);
+ *
+ * head is only written by the producer and tail only by the consumer,
+ * each on its own cache line. The producer rings the consumer's CLINT
+ * msip doorbell when the message it published found the ring empty: a
+ * consumer that drains every message before the next one gets a
+ * doorbell for nearly each of them, one that falls behind gets none
+ * until it catches up. mstatus.MIE stays clear, so the doorbell never
+ * interrupts; it only ends the wfi of a consumer in hartq_sleep(), which
+ * never misses one. The task runtime
+ * (sifive/task.h) uses msip the same way, a hart in one of them sees
+ * the other's doorbells only as spurious wakeups.
+ */
+
+#ifndef HARTQ_ORDER
+#define HARTQ_ORDER 4
+#endif
+
+#define HARTQ_SIZE (1 << HARTQ_ORDER)
+#define HARTQ_MASK (HARTQ_SIZE - 1)
+
+#define HARTQ_CACHE_LINE 64
+
+typedef struct {
+  volatile uint32_t head;
+  uint32_t rings;
+  uint8_t pad0[HARTQ_CACHE_LINE - 2 * sizeof(uint32_t)];
+  volatile uint32_t tail;
+  uint8_t pad1[HARTQ_CACHE_LINE - sizeof(uint32_t)];
+  uint32_t consumer;
+  volatile uintptr_t slot[HARTQ_SIZE];
+} __attribute__((aligned(HARTQ_CACHE_LINE))) hartq_t;
+
+#define HARTQ_INIT(hart) { .head = 0, .tail = 0, .consumer = (hart) }
+
+/* Also orders the msip MMIO store against the ring accesses */
+static inline void hartq_fence(void)
+{
+  __asm__ __volatile__ ("fence" ::: "memory");
+}
+
+/* Producer side, returns 0 when the ring is full */
+static inline int hartq_send(hartq_t *q, uintptr_t msg)
+{
+  uint32_t h = q->head;
+
+  if (h - atomic32_load(&q->tail, MO_ACQUIRE) >= HARTQ_SIZE) {
+    return 0;
+  }
+  q->slot[h & HARTQ_MASK] = msg;
+  atomic32_store(&q->head, h + 1, MO_RELEASE);
+  /* pairs with the fence in hartq_sleep(): either the consumer sees the
+   * new head or we see the tail it left before going to sleep */
+  hartq_fence();
+  if (q->tail == h) {
+    q->rings++;
+    CLINT_REG(CLINT_MSIP + q->consumer * CLINT_MSIP_size) = 1;
+  }
+  return 1;
+}
+
+/* Consumer side, returns 0 when the ring is empty */
+static inline int hartq_recv(hartq_t *q, uintptr_t *msg)
+{
+  uint32_t t = q->tail;
+
+  if (atomic32_load(&q->head, MO_ACQUIRE) == t) {
+    return 0;
+  }
+  *msg = q->slot[t & HARTQ_MASK];
+  atomic32_store(&q->tail, t + 1, MO_RELEASE);
+  return 1;
+}
+
+static inline int hartq_empty(const hartq_t *q)
+{
+  return q->head == q->tail;
+}
+
+/* Consumer side: sleeps in wfi until one of the n rings, all consumed
+ * by the calling hart, holds a message. Leaves msip cleared. */
+void hartq_sleep(hartq_t *const *qs, int n);
+
+#endif
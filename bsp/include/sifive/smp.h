@@ -5,13 +5,16 @@
 #ifndef MAX_HARTS
 #define MAX_HARTS 32
 #endif
-#define CLINT_END_HART_IPI CLINT_CTRL_ADDR + (MAX_HARTS*4)
 
 // The hart that non-SMP tests should run on
 #ifndef NONSMP_HART
 #define NONSMP_HART 0
 #endif
 
+/* start.S writes this to the lowest word of every hart's stack, see
+ * hart_stack_intact() */
+#define STACK_CANARY 0x5354434b
+
 /* If your test cannot handle multiple-threads, use this: 
  *   smp_disable(reg1)
  */
@@ -29,6 +32,12 @@ hart0_entry:
  *    ... single-threaded work ...
  *    smp_resume(reg1, reg2)
  *    ... multi-threaded work ...
+ *
+ * The other harts sleep in wfi with only the software interrupt
+ * enabled. In smp_resume hart 0 calls smp_release(), which wakes them
+ * with one msip write each, while they fall through with their msip
+ * still set. They need a stack and have to call smp_boot_secondary()
+ * next, which clears msip and meets hart 0 in the boot barrier.
  */
 
 #define smp_pause(reg1, reg2)	 \
@@ -38,28 +47,74 @@ hart0_entry:
   bnez reg2, 42f
 
 #define smp_resume(reg1, reg2)	 \
-  li reg1, CLINT_CTRL_ADDR	;\
-41:				;\
-  li reg2, 1			;\
-  sw reg2, 0(reg1)		;\
-  addi reg1, reg1, 4		;\
-  li reg2, CLINT_END_HART_IPI	;\
-  blt reg1, reg2, 41b		;\
+  call smp_release		;\
+  j 43f				;\
 42:				;\
   wfi    			;\
   csrr reg2, mip		;\
   andi reg2, reg2, 0x8		;\
   beqz reg2, 42b		;\
-  li reg1, CLINT_CTRL_ADDR	;\
-  csrr reg2, mhartid		;\
-  slli reg2, reg2, 2		;\
-  add reg2, reg2, reg1		;\
-  sw zero, 0(reg2)		;\
-41:				;\
-  lw reg2, 0(reg1)		;\
-  bnez reg2, 41b		;\
-  addi reg1, reg1, 4		;\
-  li reg2, CLINT_END_HART_IPI	;\
-  blt reg1, reg2, 41b
+43:
+
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+
+/* Stacks and TLS blocks of the harts as laid out by the linker script.
+ * SMP_HARTS in the Makefile sets how many there are, 1 without
+ * ENABLE_SMP. The sizes are linker symbols, their address is the value. */
+extern char _sp[], __stack_size[], __hart_stack_size[], __smp_harts[];
+extern char __tls_base[], __tls_block_size[];
+
+/* Number of harts that came up, found by smp_release() at boot: the
+ * harts below SMP_HARTS whose CLINT msip register exists. 1 without
+ * ENABLE_SMP. */
+extern volatile uint32_t smp_nharts;
+
+static inline int smp_harts(void)
+{
+  return (int)smp_nharts;
+}
+
+/* Waits for all smp_harts() harts */
+void smp_barrier(void);
+
+/* mcycles hart 0 spent in smp_release(), from the first msip write to
+ * leaving the boot barrier together with the last hart */
+extern uint32_t smp_release_cycles;
+
+void smp_release(void);
+void smp_boot_secondary(int hartid);
+
+static inline uintptr_t hart_stack_size(int hartid)
+{
+  return (uintptr_t)(hartid ? __hart_stack_size : __stack_size);
+}
+
+static inline uintptr_t hart_stack_top(int hartid)
+{
+  if (hartid == 0) {
+    return (uintptr_t)_sp;
+  }
+  return (uintptr_t)_sp - (uintptr_t)__stack_size -
+         (hartid - 1) * (uintptr_t)__hart_stack_size;
+}
+
+static inline uintptr_t hart_stack_bottom(int hartid)
+{
+  return hart_stack_top(hartid) - hart_stack_size(hartid);
+}
+
+static inline void *hart_tls(int hartid)
+{
+  return __tls_base + hartid * (uintptr_t)__tls_block_size;
+}
+
+/* Whether the canary below the stack of hartid survived so far. Always
+ * false with STACK_GUARD_PMP, an overflow faults right away there. */
+static inline int hart_stack_intact(int hartid)
+{
+  return *(volatile uint32_t *)hart_stack_bottom(hartid) == STACK_CANARY;
+}
+#endif
 
 #endif
@@ -0,0 +1,177 @@
+// See LICENSE for license details.
+#ifndef SIFIVE_SYNC_H
+#define SIFIVE_SYNC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sifive/atomic.h"
+
+/* Locks and barriers for code running on several harts (ENABLE_SMP).
+ *
+ * Built on sifive/atomic.h. Acquire and release ordering comes from
+ * the .aq/.rl bits of the AMO and LR/SC instructions, or from
+ * "fence r,rw" after a plain load that observed the lock free and
+ * "fence rw,w" before a plain store that frees it. No full fence is
+ * needed anywhere.
+ *
+ * spinlock_t   test-and-test-and-set: waiters spin on a plain load and
+ *              only issue the amoswap once the lock looks free.
+ * ticketlock_t amoadd hands out tickets, harts get the lock in FIFO
+ *              order. All waiters spin on the same word.
+ * mcslock_t    queue lock: every waiter spins on its own mcsnode_t, so
+ *              a release only touches the next waiter's cache line.
+ * barrier_t    sense-reversing barrier: arrivals count up with amoadd,
+ *              the last one resets the count and flips the sense word
+ *              everybody else spins on.
+ */
+
+#define SYNC_ACQUIRE_FENCE() atomic_fence(MO_ACQUIRE)
+#define SYNC_RELEASE_FENCE() atomic_fence(MO_RELEASE)
+
+static inline void sync_relax(void)
+{
+  /* keeps the spin loop from being optimized into one load */
+  __asm__ __volatile__ ("" ::: "memory");
+}
+
+/* Test-and-test-and-set spin lock */
+
+typedef struct {
+  volatile uint32_t locked;
+} spinlock_t;
+
+#define SPINLOCK_INIT { .locked = 0 }
+
+static inline int spin_trylock(spinlock_t *l)
+{
+  return atomic32_exchange(&l->locked, 1, MO_ACQUIRE) == 0;
+}
+
+static inline void spin_lock(spinlock_t *l)
+{
+  while (!spin_trylock(l)) {
+    while (l->locked) {
+      sync_relax();
+    }
+  }
+}
+
+static inline void spin_unlock(spinlock_t *l)
+{
+  atomic32_store(&l->locked, 0, MO_RELEASE);
+}
+
+/* Ticket lock */
+
+typedef struct {
+  volatile uint32_t next;
+  volatile uint32_t owner;
+} ticketlock_t;
+
+#define TICKETLOCK_INIT { .next = 0, .owner = 0 }
+
+static inline void ticket_lock(ticketlock_t *l)
+{
+  uint32_t ticket = atomic32_fetch_add(&l->next, 1, MO_RELAXED);
+
+  while (l->owner != ticket) {
+    sync_relax();
+  }
+  SYNC_ACQUIRE_FENCE();
+}
+
+static inline int ticket_trylock(ticketlock_t *l)
+{
+  uint32_t owner = l->owner;
+
+  /* take a ticket only if it is the one being served */
+  return atomic32_cas(&l->next, &owner, owner + 1, MO_ACQUIRE);
+}
+
+static inline void ticket_unlock(ticketlock_t *l)
+{
+  SYNC_RELEASE_FENCE();
+  /* only the holder writes owner */
+  atomic32_store(&l->owner, l->owner + 1, MO_RELAXED);
+}
+
+/* MCS queue lock, every acquirer passes its own node which must stay
+ * valid until the matching mcs_unlock() */
+
+typedef struct mcsnode {
+  struct mcsnode *volatile next;
+  volatile uint32_t locked;
+} mcsnode_t;
+
+typedef struct {
+  mcsnode_t *volatile tail;
+} mcslock_t;
+
+#define MCSLOCK_INIT { .tail = NULL }
+
+static inline void mcs_lock(mcslock_t *l, mcsnode_t *me)
+{
+  mcsnode_t *prev;
+
+  me->next = NULL;
+  me->locked = 1;
+  /* .rl publishes the node initialization, .aq orders the critical
+   * section after the swap when the lock was free */
+  prev = atomicptr_exchange((void *volatile *)&l->tail, me, MO_ACQ_REL);
+  if (prev) {
+    prev->next = me;
+    while (me->locked) {
+      sync_relax();
+    }
+    SYNC_ACQUIRE_FENCE();
+  }
+}
+
+static inline void mcs_unlock(mcslock_t *l, mcsnode_t *me)
+{
+  mcsnode_t *next = me->next;
+
+  if (!next) {
+    void *tmp = me;
+
+    /* no known successor: try to swing tail back to empty */
+    if (atomicptr_cas((void *volatile *)&l->tail, &tmp, NULL, MO_RELEASE)) {
+      return;
+    }
+    /* a successor swapped itself in but has not linked up yet */
+    while (!(next = me->next)) {
+      sync_relax();
+    }
+  }
+  SYNC_RELEASE_FENCE();
+  next->locked = 0;
+}
+
+/* Sense-reversing barrier for n harts. The sense word is read before
+ * arriving, it cannot flip until this hart has arrived, so no per-hart
+ * state is needed. The same barrier_t can be reused right away, also
+ * with a different n. */
+
+typedef struct {
+  volatile uint32_t count;
+  volatile uint32_t sense;
+} barrier_t;
+
+#define BARRIER_INIT { .count = 0, .sense = 0 }
+
+static inline void barrier_wait(barrier_t *b, uint32_t n)
+{
+  uint32_t sense = atomic32_load(&b->sense, MO_RELAXED);
+
+  if (atomic32_fetch_add(&b->count, 1, MO_ACQ_REL) == n - 1) {
+    b->count = 0;
+    atomic32_store(&b->sense, sense + 1, MO_RELEASE);
+  } else {
+    while (b->sense == sense) {
+      sync_relax();
+    }
+    SYNC_ACQUIRE_FENCE();
+  }
+}
+
+#endif
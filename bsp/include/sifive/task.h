@@ -0,0 +1,78 @@
+// See LICENSE for license details.
+#ifndef SIFIVE_TASK_H
+#define SIFIVE_TASK_H
+
+#include <stdint.h>
+#include "sifive/atomic.h"
+
+/* Work-stealing task runtime for ENABLE_SMP builds.
+ *
+ * Every hart owns a Chase-Lev deque of spawned tasks. The owner pushes
+ * and pops at the bottom, idle harts steal from the top of a victim's
+ * deque. Secondary harts enter the runtime with task_worker() from
+ * secondary_main(); when there is nothing to steal they sleep in wfi
+ * and are woken by a CLINT msip IPI from the next task_spawn().
+ *
+ *   task_group_t g = TASK_GROUP_INIT;
+ *   task_t t;
+ *
+ *   task_spawn(&g, &t, fn, arg);  // may run on any hart
+ *   ...                           // meanwhile, on this hart
+ *   task_sync(&g);                // runs queued tasks until g is done
+ *
+ * The task_t and whatever arg points to belong to the caller and have
+ * to stay valid until task_sync() returns. A task may spawn and sync
+ * groups of its own. When the own deque is full task_spawn() runs the
+ * task inline.
+ */
+
+#ifndef TASK_MAX_HARTS
+#define TASK_MAX_HARTS 8
+#endif
+
+#ifndef TASK_DEQUE_ORDER
+#define TASK_DEQUE_ORDER 5
+#endif
+
+#define TASK_DEQUE_SIZE (1 << TASK_DEQUE_ORDER)
+#define TASK_DEQUE_MASK (TASK_DEQUE_SIZE - 1)
+
+#define TASK_CACHE_LINE 64
+
+typedef struct {
+  volatile uint32_t pending;
+} task_group_t;
+
+#define TASK_GROUP_INIT { .pending = 0 }
+
+typedef struct task {
+  void (*fn)(void *arg);
+  void *arg;
+  task_group_t *group;
+} task_t;
+
+/* Called once on hart 0 before anything is spawned. Meets the
+ * secondary harts in smp_barrier() once all of them have checked in
+ * with task_worker() and returns the number of harts that will run
+ * tasks, smp_harts() but at most TASK_MAX_HARTS. */
+int task_init(void);
+
+/* Never returns, call it from secondary_main() on every secondary
+ * hart, task_init() waits for all of them */
+void task_worker(int hartid) __attribute__((noreturn));
+
+/* Restrict stealing to harts 0..n-1, the others sleep. For measuring
+ * scaling, by default all harts that checked in take part. */
+void task_set_harts(int n);
+
+void task_spawn(task_group_t *g, task_t *t, void (*fn)(void *arg), void *arg);
+void task_sync(task_group_t *g);
+
+/* Calls body(lo, hi, arg) on disjoint subranges of [begin, end) no
+ * longer than grain, spread over all harts. Returns once every range
+ * is done. The range is split in halves recursively, the stack of the
+ * calling hart grows by one frame per halving. */
+void task_parallel_for(int begin, int end, int grain,
+                       void (*body)(int lo, int hi, void *arg), void *arg);
+
+#endif
@@ -0,0 +1,100 @@
+// See LICENSE for license details.
+#ifndef _SIFIVE_TRACE_H
+#define _SIFIVE_TRACE_H
+
+#include <stdint.h>
+#include "encoding.h"
+#include "sifive/atomic.h"
+
+/* Deferred binary logging.
+ *
+ * TRACE(fmt, ...) stores a record into trace_ring instead of formatting:
+ * a header word holding the argument count and the offset of fmt in the
+ * .trace_fmt section, the low word of mcycle, and up to four arguments
+ * cast to 32 bit. .trace_fmt is an INFO section in the linker scripts,
+ * so the format strings stay in the ELF but are never loaded.
+ *
+ * Space is reserved with a CAS on head and a record becomes visible to
+ * the reader when its header is stored, so TRACE() may be used from
+ * interrupt handlers and costs a few tens of cycles. When the ring is
+ * full the record is dropped and counted.
+ *
+ * The single reader is trace_drain(), which prints pending records as
+ * "@T" lines for bsp/tools/trace_decode.py, or a debugger dumping
+ * trace_ring. Arguments are 32 bit integers: use %d %i %u %x %X %o %c
+ * %p, or %s for pointers to strings in a loaded section of the ELF.
+ */
+
+#ifndef TRACE_BUF_ORDER
+#define TRACE_BUF_ORDER 8
+#endif
+#define TRACE_BUF_WORDS (1u << TRACE_BUF_ORDER)
+#define TRACE_BUF_MASK (TRACE_BUF_WORDS - 1)
+
+#define TRACE_HDR_VALID 0x80000000u
+#define TRACE_HDR_NARGS(h) (((h) >> 24) & 0x7)
+#define TRACE_HDR_ID(h) ((h) & 0xffffff)
+#define TRACE_MAX_WORDS 6
+
+struct trace_ring {
+  uint32_t words;
+  volatile uint32_t head;
+  volatile uint32_t tail;
+  volatile uint32_t dropped;
+  volatile uint32_t buf[TRACE_BUF_WORDS];
+};
+
+extern struct trace_ring trace_ring;
+
+int trace_read(uint32_t *rec);
+void trace_drain(void);
+
+static inline void trace_record(uint32_t id, uint32_t nargs, uint32_t a0,
+                                uint32_t a1, uint32_t a2, uint32_t a3)
+{
+  uint32_t len = nargs + 2;
+  uint32_t h = atomic32_load(&trace_ring.head, MO_RELAXED);
+
+  do {
+    if (h + len - trace_ring.tail > TRACE_BUF_WORDS) {
+      atomic32_fetch_add(&trace_ring.dropped, 1, MO_RELAXED);
+      return;
+    }
+  } while (!atomic32_cas(&trace_ring.head, &h, h + len, MO_RELAXED));
+
+  trace_ring.buf[(h + 1) & TRACE_BUF_MASK] = (uint32_t)read_csr(mcycle);
+  if (nargs > 0) trace_ring.buf[(h + 2) & TRACE_BUF_MASK] = a0;
+  if (nargs > 1) trace_ring.buf[(h + 3) & TRACE_BUF_MASK] = a1;
+  if (nargs > 2) trace_ring.buf[(h + 4) & TRACE_BUF_MASK] = a2;
+  if (nargs > 3) trace_ring.buf[(h + 5) & TRACE_BUF_MASK] = a3;
+  atomic32_store(&trace_ring.buf[h & TRACE_BUF_MASK],
+                 TRACE_HDR_VALID | (nargs << 24) | id, MO_RELEASE);
+}
+
+/* only there to have fmt checked against the arguments */
+static inline void __attribute__((format(printf, 1, 2)))
+_trace_check(const char *fmt, ...)
+{
+}
+
+#define _TRACE_NARGS(...) _TRACE_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define _TRACE_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+#define _TRACE_ARG(n, ...) _TRACE_ARG_(n, ##__VA_ARGS__, 0, 0, 0, 0, 0)
+#define _TRACE_ARG_(n, ...) _TRACE_ARG_##n(__VA_ARGS__)
+#define _TRACE_ARG_0(a, ...) ((uint32_t)(uintptr_t)(a))
+#define _TRACE_ARG_1(a, b, ...) ((uint32_t)(uintptr_t)(b))
+#define _TRACE_ARG_2(a, b, c, ...) ((uint32_t)(uintptr_t)(c))
+#define _TRACE_ARG_3(a, b, c, d, ...) ((uint32_t)(uintptr_t)(d))
+
+#define TRACE(fmt, ...)                                                 \
+  do {                                                                  \
+    static const char _trace_fmt[]                                      \
+      __attribute__((section(".trace_fmt"), used, aligned(1))) = fmt;   \
+    if (0) _trace_check(fmt, ##__VA_ARGS__);                            \
+    trace_record((uint32_t)(uintptr_t)_trace_fmt,                       \
+                 _TRACE_NARGS(__VA_ARGS__),                             \
+                 _TRACE_ARG(0, ##__VA_ARGS__), _TRACE_ARG(1, ##__VA_ARGS__), \
+                 _TRACE_ARG(2, ##__VA_ARGS__), _TRACE_ARG(3, ##__VA_ARGS__)); \
+  } while (0)
+
+#endif /* _SIFIVE_TRACE_H */
@@ -12,6 +12,7 @@ LIBWRAP_SRCS := \
 	sys/lseek.c \
 	sys/read.c \
 	sys/write.c \
+	sys/setvbuf.c \
 	sys/fstat.c \
 	sys/stat.c \
 	sys/close.c \
@@ -27,7 +28,16 @@ LIBWRAP_SRCS := \
 	sys/sbrk.c \
 	sys/_exit.c \
 	sys/puts.c \
-	misc/write_hex.c
+	misc/write_hex.c \
+	misc/fmt_num.c \
+	misc/uart_write.c \
+	misc/bsp_printf.c \
+	misc/trace.c \
+	misc/atomic64.c \
+	misc/task.c \
+	misc/smp.c \
+	misc/hartq.c \
+	misc/bench.c
 
 LIBWRAP_SRCS := $(foreach f,$(LIBWRAP_SRCS),$(LIBWRAP_DIR)/$(f))
 LIBWRAP_OBJS := $(LIBWRAP_SRCS:.c=.o)
@@ -35,7 +45,13 @@ LIBWRAP_OBJS := $(LIBWRAP_SRCS:.c=.o)
 LIBWRAP_SYMS := malloc free \
 	open lseek read write fstat stat close link unlink \
 	execve fork getpid kill wait \
-	isatty times sbrk _exit puts
+	isatty times sbrk _exit puts setvbuf
+
+# newlib's stdout FILE is shared by all harts and not locked, SMP builds
+# send printf through bsp_vprintf() and the per-hart stdout buffers
+ifneq ($(filter -DENABLE_SMP,$(CFLAGS)),)
+LIBWRAP_SYMS += printf vprintf
+endif
 
 LIBWRAP := libwrap.a
 
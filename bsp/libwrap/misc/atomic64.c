@@ -0,0 +1,114 @@
+/* See LICENSE of license details. */
+
+#include <stdint.h>
+#include "encoding.h"
+#include "sifive/atomic.h"
+
+#if __riscv_xlen == 32
+
+/* RV32 has no 64-bit AMOs or LR/SC, every atomic64_* takes one of these
+ * locks, picked by the address of the doubleword. Interrupts are masked
+ * while a lock is held so a handler using the same lock cannot deadlock
+ * against the code it interrupted. */
+
+#define ATOMIC64_LOCKS_ORDER 4
+#define ATOMIC64_LOCKS (1 << ATOMIC64_LOCKS_ORDER)
+
+static volatile uint32_t atomic64_locks[ATOMIC64_LOCKS];
+
+static volatile uint32_t *atomic64_lock_for(const volatile void *p)
+{
+  uintptr_t a = (uintptr_t)p >> 3;
+
+  return &atomic64_locks[(a ^ (a >> ATOMIC64_LOCKS_ORDER)) &
+                         (ATOMIC64_LOCKS - 1)];
+}
+
+static uintptr_t atomic64_lock(volatile uint32_t *l)
+{
+  uintptr_t mstatus = clear_csr(mstatus, MSTATUS_MIE);
+
+  while (atomic32_exchange(l, 1, MO_SEQ_CST)) {
+    while (atomic32_load(l, MO_RELAXED))
+      ;
+  }
+  return mstatus;
+}
+
+static void atomic64_unlock(volatile uint32_t *l, uintptr_t mstatus)
+{
+  atomic32_exchange(l, 0, MO_RELEASE);
+  if (mstatus & MSTATUS_MIE) {
+    set_csr(mstatus, MSTATUS_MIE);
+  }
+}
+
+#define ATOMIC64_RMW(name, type, expr)                          \
+type atomic64_fetch_##name(volatile type *p, type v, memorder_t mo) \
+{                                                               \
+  volatile uint32_t *l = atomic64_lock_for(p);                  \
+  uintptr_t s = atomic64_lock(l);                               \
+  type old = *p;                                                \
+  *p = (expr);                                                  \
+  atomic64_unlock(l, s);                                        \
+  return old;                                                   \
+}
+
+ATOMIC64_RMW(add, uint64_t, old + v)
+ATOMIC64_RMW(sub, uint64_t, old - v)
+ATOMIC64_RMW(and, uint64_t, old & v)
+ATOMIC64_RMW(or, uint64_t, old | v)
+ATOMIC64_RMW(xor, uint64_t, old ^ v)
+ATOMIC64_RMW(minu, uint64_t, old < v ? old : v)
+ATOMIC64_RMW(maxu, uint64_t, old > v ? old : v)
+ATOMIC64_RMW(min, int64_t, old < v ? old : v)
+ATOMIC64_RMW(max, int64_t, old > v ? old : v)
+
+uint64_t atomic64_exchange(volatile uint64_t *p, uint64_t v, memorder_t mo)
+{
+  volatile uint32_t *l = atomic64_lock_for(p);
+  uintptr_t s = atomic64_lock(l);
+  uint64_t old = *p;
+
+  *p = v;
+  atomic64_unlock(l, s);
+  return old;
+}
+
+int atomic64_cas(volatile uint64_t *p, uint64_t *expected, uint64_t desired,
+                 memorder_t mo)
+{
+  volatile uint32_t *l = atomic64_lock_for(p);
+  uintptr_t s = atomic64_lock(l);
+  uint64_t old = *p;
+  int ok = old == *expected;
+
+  if (ok) {
+    *p = desired;
+  }
+  atomic64_unlock(l, s);
+  *expected = old;
+  return ok;
+}
+
+/* the two halves are separate loads, so a plain load could tear */
+uint64_t atomic64_load(const volatile uint64_t *p, memorder_t mo)
+{
+  volatile uint32_t *l = atomic64_lock_for(p);
+  uintptr_t s = atomic64_lock(l);
+  uint64_t v = *p;
+
+  atomic64_unlock(l, s);
+  return v;
+}
+
+void atomic64_store(volatile uint64_t *p, uint64_t v, memorder_t mo)
+{
+  volatile uint32_t *l = atomic64_lock_for(p);
+  uintptr_t s = atomic64_lock(l);
+
+  *p = v;
+  atomic64_unlock(l, s);
+}
+
+#endif
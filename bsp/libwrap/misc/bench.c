@@ -0,0 +1,178 @@
+/* See LICENSE of license details. */
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <unistd.h>
+#include "sifive/bench.h"
+#include "sifive/bsp_printf.h"
+
+static bench_t *bench_head, **bench_tail = &bench_head;
+
+void bench_register(bench_t *b)
+{
+  b->next = NULL;
+  *bench_tail = b;
+  bench_tail = &b->next;
+}
+
+/* A record goes out with a single write(), so lines from a benchmark
+ * and from other harts do not mix */
+static char record[256];
+static size_t record_len;
+
+static void record_add(const char *fmt, ...)
+{
+  va_list ap;
+  size_t room = sizeof(record) - record_len;
+  int n;
+
+  va_start(ap, fmt);
+  n = bsp_vsnprintf(record + record_len, room, fmt, ap);
+  va_end(ap);
+  record_len += (size_t)n < room ? (size_t)n : room - 1;
+}
+
+void bench_record_begin(const char *name)
+{
+  record_len = 0;
+  record_add("{\"bench\":\"%s\"", name);
+}
+
+void bench_record_u64(const char *key, uint64_t v)
+{
+  record_add(",\"%s\":%llu", key, (unsigned long long)v);
+}
+
+void bench_record_str(const char *key, const char *v)
+{
+  record_add(",\"%s\":\"%s\"", key, v);
+}
+
+void bench_record_fixed(const char *key, uint64_t v, int decimals)
+{
+  uint64_t scale = 1;
+
+  for (int i = 0; i < decimals; i++) {
+    scale *= 10;
+  }
+  if (decimals > 0) {
+    record_add(",\"%s\":%llu.%0*llu", key, (unsigned long long)(v / scale),
+               decimals, (unsigned long long)(v % scale));
+  } else {
+    bench_record_u64(key, v);
+  }
+}
+
+void bench_record_end(void)
+{
+  /* a truncated record still has to end the line */
+  if (record_len > sizeof(record) - 3) {
+    record_len = sizeof(record) - 3;
+  }
+  record[record_len++] = '}';
+  record[record_len++] = '\n';
+  write(STDOUT_FILENO, record, record_len);
+}
+
+void bench_end(void)
+{
+  bench_record_begin("_end");
+  bench_record_end();
+}
+
+static void bench_call(bench_t *b)
+{
+  b->cycles = 0;
+  b->instret = 0;
+  b->cycles_set = 0;
+  bench_resume(b);
+  b->fn(b);
+  bench_pause(b);
+  if (b->cycles_set) {
+    b->cycles = b->set_cycles;
+  }
+}
+
+static void bench_empty(bench_t *b)
+{
+}
+
+/* cycles and minstret of bench_call() around an empty body */
+static uint64_t overhead_cycles, overhead_instret;
+
+static void bench_calibrate(void)
+{
+  bench_t empty = { .name = "empty", .fn = bench_empty };
+
+  overhead_cycles = UINT64_MAX;
+  for (int i = 0; i < 4; i++) {
+    bench_call(&empty);
+    if (empty.cycles < overhead_cycles) {
+      overhead_cycles = empty.cycles;
+      overhead_instret = empty.instret;
+    }
+  }
+}
+
+static uint64_t less_overhead(uint64_t v, uint64_t overhead)
+{
+  return v > overhead ? v - overhead : 0;
+}
+
+static void bench_run(bench_t *b)
+{
+  uint64_t cycles[BENCH_MAX_REPS];
+  uint64_t instret = 0;
+  uint32_t reps = b->reps < BENCH_MAX_REPS ? b->reps : BENCH_MAX_REPS;
+  uint32_t n;
+
+  b->skipped = 0;
+  for (n = 0; n < b->warmup && !b->skipped; n++) {
+    bench_call(b);
+  }
+  for (n = 0; n < reps && !b->skipped; n++) {
+    uint64_t c;
+    uint32_t i = n;
+
+    bench_call(b);
+    c = b->cycles_set ? b->cycles : less_overhead(b->cycles, overhead_cycles);
+    /* insertion sort, so the median is at n / 2 in the end */
+    while (i > 0 && cycles[i - 1] > c) {
+      cycles[i] = cycles[i - 1];
+      i--;
+    }
+    cycles[i] = c;
+    if (i == 0) {
+      instret = less_overhead(b->instret, overhead_instret);
+    }
+  }
+
+  bench_record_begin(b->name);
+  if (b->skipped || n == 0) {
+    record_add(",\"skipped\":true");
+    bench_record_end();
+    return;
+  }
+  bench_record_u64("reps", n);
+  bench_record_u64("ops", b->ops);
+  bench_record_str("unit", b->unit);
+  bench_record_u64("cycles_min", cycles[0]);
+  bench_record_u64("cycles_med", cycles[n / 2]);
+  bench_record_u64("cycles_max", cycles[n - 1]);
+  bench_record_u64("instret", instret);
+  bench_record_fixed("cycles_per_op", cycles[0] * 1000 / (b->ops ? b->ops : 1), 3);
+  bench_record_end();
+}
+
+int bench_run_all(void)
+{
+  int count = 0;
+
+  bench_calibrate();
+  for (bench_t *b = bench_head; b; b = b->next) {
+    bench_run(b);
+    count++;
+  }
+  return count;
+}
@@ -0,0 +1,411 @@
+/* See LICENSE of license details. */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "sifive/bsp_printf.h"
+
+#define BSP_PRINTF_CHUNK 32
+
+/* Output state: either a caller buffer (fd < 0) or a chunk that is
+ * written to fd whenever it fills up.
+ */
+struct out {
+  char *buf;
+  size_t size;
+  size_t len;
+  int fd;
+  size_t pos;
+  char chunk[BSP_PRINTF_CHUNK];
+};
+
+static void out_flush(struct out *o)
+{
+  if (o->pos) {
+    write(o->fd, o->chunk, o->pos);
+    o->pos = 0;
+  }
+}
+
+static void out_char(struct out *o, char c)
+{
+  if (o->fd >= 0) {
+    o->chunk[o->pos++] = c;
+    if (o->pos == BSP_PRINTF_CHUNK) {
+      out_flush(o);
+    }
+  } else if (o->len + 1 < o->size) {
+    o->buf[o->len] = c;
+  }
+  o->len++;
+}
+
+static void out_pad(struct out *o, char c, int n)
+{
+  while (n-- > 0) {
+    out_char(o, c);
+  }
+}
+
+#define F_LEFT  0x01
+#define F_ZERO  0x02
+#define F_PLUS  0x04
+#define F_SPACE 0x08
+#define F_UPPER 0x10
+#define F_ALT   0x20
+
+/* Emits sign, prefix and the digits in tmp[0..n) (most significant
+ * last) padded to width and zero extended to prec digits.
+ */
+static void out_number(struct out *o, const char *tmp, int n, char sign,
+                       const char *prefix, int width, int prec, int flags)
+{
+  int plen = 0;
+  int zeros = prec > n ? prec - n : 0;
+  int total;
+
+  while (prefix && prefix[plen]) {
+    plen++;
+  }
+  total = (sign ? 1 : 0) + plen + zeros + n;
+  /* '0' only pads when there is no precision, as in C */
+  if ((flags & F_ZERO) && prec < 0 && width > total) {
+    zeros += width - total;
+    total = width;
+  }
+  if (!(flags & F_LEFT)) {
+    out_pad(o, ' ', width - total);
+  }
+  if (sign) {
+    out_char(o, sign);
+  }
+  while (plen-- > 0) {
+    out_char(o, *prefix++);
+  }
+  out_pad(o, '0', zeros);
+  while (n-- > 0) {
+    out_char(o, tmp[n]);
+  }
+  if (flags & F_LEFT) {
+    out_pad(o, ' ', width - total);
+  }
+}
+
+/* Digits of num in base, least significant first. 32 bit values are
+ * converted with 32 bit division, which rv32 has in hardware.
+ */
+static int to_digits(char *tmp, unsigned long long num, unsigned base, int upper)
+{
+  const char *digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+  int n = 0;
+
+  while (num > 0xffffffffULL) {
+    tmp[n++] = digits[num % base];
+    num /= base;
+  }
+  for (unsigned long v = (unsigned long)num; v; v /= base) {
+    tmp[n++] = digits[v % base];
+  }
+  return n;
+}
+
+#ifdef BSP_PRINTF_FLOAT
+static void out_double(struct out *o, double d, int width, int prec, int flags)
+{
+  static const uint32_t pow10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+  };
+  char tmp[32];
+  char sign = 0;
+  unsigned long long ipart;
+  uint32_t fpart;
+  int n;
+
+  if (prec < 0) {
+    prec = 6;
+  } else if (prec > 9) {
+    prec = 9;
+  }
+  if (d != d) {
+    out_number(o, "nan", 3, 0, NULL, width, -1, flags & ~F_ZERO);
+    return;
+  }
+  if (d < 0) {
+    sign = '-';
+    d = -d;
+  } else if (flags & F_PLUS) {
+    sign = '+';
+  } else if (flags & F_SPACE) {
+    sign = ' ';
+  }
+  if (d >= 18446744073709551616.0) {
+    /* out_number() takes its digits reversed */
+    out_number(o, "fni", 3, sign, NULL, width, -1, flags & ~F_ZERO);
+    return;
+  }
+
+  ipart = (unsigned long long)d;
+  d = (d - (double)ipart) * pow10[prec] + 0.5;
+  fpart = (uint32_t)d;
+  if (fpart >= pow10[prec]) {
+    fpart -= pow10[prec];
+    ipart++;
+  }
+
+  /* fraction, then the point, then the integer part, all reversed */
+  for (n = 0; n < prec; n++) {
+    tmp[n] = '0' + fpart % 10;
+    fpart /= 10;
+  }
+  if (prec || (flags & F_ALT)) {
+    tmp[n++] = '.';
+  }
+  n += to_digits(tmp + n, ipart, 10, 0);
+  if (!ipart) {
+    tmp[n++] = '0';
+  }
+  out_number(o, tmp, n, sign, NULL, width, -1, flags);
+}
+#endif
+
+static int format(struct out *o, const char *fmt, va_list ap)
+{
+  char tmp[24];
+
+  for (; *fmt; fmt++) {
+    int flags = 0, width = 0, prec = -1, lng = 0;
+    unsigned long long num;
+    unsigned base = 10;
+    const char *prefix = NULL;
+    char sign = 0;
+
+    if (*fmt != '%') {
+      out_char(o, *fmt);
+      continue;
+    }
+
+    for (;; fmt++) {
+      char c = fmt[1];
+      if (c == '-') flags |= F_LEFT;
+      else if (c == '0') flags |= F_ZERO;
+      else if (c == '+') flags |= F_PLUS;
+      else if (c == ' ') flags |= F_SPACE;
+      else if (c == '#') flags |= F_ALT;
+      else break;
+    }
+    fmt++;
+
+    if (*fmt == '*') {
+      width = va_arg(ap, int);
+      if (width < 0) {
+        flags |= F_LEFT;
+        width = -width;
+      }
+      fmt++;
+    } else {
+      while (*fmt >= '0' && *fmt <= '9') {
+        width = width * 10 + *fmt++ - '0';
+      }
+    }
+    if (*fmt == '.') {
+      fmt++;
+      prec = 0;
+      if (*fmt == '*') {
+        prec = va_arg(ap, int);
+        fmt++;
+      } else {
+        while (*fmt >= '0' && *fmt <= '9') {
+          prec = prec * 10 + *fmt++ - '0';
+        }
+      }
+    }
+
+    /* lng: 0 int, 1 long, 2 long long, -1 short, -2 char */
+    for (;; fmt++) {
+      if (*fmt == 'l') lng = lng > 0 ? 2 : 1;
+      else if (*fmt == 'h') lng = lng < 0 ? -2 : -1;
+      else if (*fmt == 'z') lng = sizeof(size_t) > sizeof(int) ? 1 : 0;
+      else break;
+    }
+
+    switch (*fmt) {
+    case 'd':
+    case 'i': {
+      long long v;
+      if (lng == 2) v = va_arg(ap, long long);
+      else if (lng == 1) v = va_arg(ap, long);
+      else v = va_arg(ap, int);
+      if (lng == -1) v = (short)v;
+      else if (lng == -2) v = (signed char)v;
+      if (v < 0) {
+        sign = '-';
+        num = -(unsigned long long)v;
+      } else {
+        sign = (flags & F_PLUS) ? '+' : (flags & F_SPACE) ? ' ' : 0;
+        num = v;
+      }
+      goto number;
+    }
+    case 'X':
+      flags |= F_UPPER;
+      /* fall through */
+    case 'x':
+      base = 16;
+      goto unsigned_number;
+    case 'o':
+      base = 8;
+      goto unsigned_number;
+    case 'p':
+      num = (uintptr_t)va_arg(ap, void *);
+      base = 16;
+      prefix = "0x";
+      goto number;
+    case 'u':
+    unsigned_number:
+      if (lng == 2) num = va_arg(ap, unsigned long long);
+      else if (lng == 1) num = va_arg(ap, unsigned long);
+      else num = va_arg(ap, unsigned int);
+      if (lng == -1) num = (unsigned short)num;
+      else if (lng == -2) num = (unsigned char)num;
+    number: {
+      int n = to_digits(tmp, num, base, flags & F_UPPER);
+      if (n == 0 && prec != 0) {
+        tmp[n++] = '0';
+      }
+      /* '#': 0x for nonzero hex, octal always starts with a 0 */
+      if ((flags & F_ALT) && base == 16 && num) {
+        prefix = (flags & F_UPPER) ? "0X" : "0x";
+      } else if ((flags & F_ALT) && base == 8 && num && prec <= n) {
+        prec = n + 1;
+      } else if ((flags & F_ALT) && base == 8 && n == 0) {
+        tmp[n++] = '0';
+      }
+      out_number(o, tmp, n, sign, prefix, width, prec, flags);
+      break;
+    }
+    case 'c':
+      tmp[0] = (char)va_arg(ap, int);
+      out_number(o, tmp, 1, 0, NULL, width, -1, flags & ~F_ZERO);
+      break;
+    case 's': {
+      const char *s = va_arg(ap, const char *);
+      int n = 0;
+      if (!s) {
+        s = "(null)";
+      }
+      while (s[n] && (prec < 0 || n < prec)) {
+        n++;
+      }
+      if (!(flags & F_LEFT)) {
+        out_pad(o, ' ', width - n);
+      }
+      for (int i = 0; i < n; i++) {
+        out_char(o, s[i]);
+      }
+      if (flags & F_LEFT) {
+        out_pad(o, ' ', width - n);
+      }
+      break;
+    }
+    case 'f':
+    case 'F': {
+      double d = va_arg(ap, double);
+#ifdef BSP_PRINTF_FLOAT
+      out_double(o, d, width, prec, flags);
+#else
+      (void)d;
+      out_char(o, '?');
+#endif
+      break;
+    }
+    case '%':
+      out_char(o, '%');
+      break;
+    default:
+      /* unknown conversion, print it as is */
+      out_char(o, '%');
+      if (!*fmt) {
+        return o->len;
+      }
+      out_char(o, *fmt);
+      break;
+    }
+  }
+  return o->len;
+}
+
+int bsp_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap)
+{
+  struct out o;
+  int len;
+
+  o.buf = buf;
+  o.size = size;
+  o.len = 0;
+  o.fd = -1;
+  o.pos = 0;
+  len = format(&o, fmt, ap);
+  if (size) {
+    buf[o.len < size ? o.len : size - 1] = '\0';
+  }
+  return len;
+}
+
+int bsp_snprintf(char *buf, size_t size, const char *fmt, ...)
+{
+  va_list ap;
+  int len;
+
+  va_start(ap, fmt);
+  len = bsp_vsnprintf(buf, size, fmt, ap);
+  va_end(ap);
+  return len;
+}
+
+int bsp_vprintf(const char *fmt, va_list ap)
+{
+  struct out o;
+  int len;
+
+  o.buf = NULL;
+  o.size = 0;
+  o.len = 0;
+  o.fd = STDOUT_FILENO;
+  o.pos = 0;
+  len = format(&o, fmt, ap);
+  out_flush(&o);
+  return len;
+}
+
+int bsp_printf(const char *fmt, ...)
+{
+  va_list ap;
+  int len;
+
+  va_start(ap, fmt);
+  len = bsp_vprintf(fmt, ap);
+  va_end(ap);
+  return len;
+}
+
+#ifdef ENABLE_SMP
+/* printf and vprintf are wrapped in SMP builds, see libwrap.mk */
+
+int __wrap_vprintf(const char *fmt, va_list ap)
+{
+  return bsp_vprintf(fmt, ap);
+}
+
+int __wrap_printf(const char *fmt, ...)
+{
+  va_list ap;
+  int len;
+
+  va_start(ap, fmt);
+  len = bsp_vprintf(fmt, ap);
+  va_end(ap);
+  return len;
+}
+#endif
@@ -0,0 +1,89 @@
+/* See LICENSE of license details. */
+
+#include <stddef.h>
+#include "platform.h"
+
+static const char hex_digits[16] = "0123456789ABCDEF";
+
+/* "00" "01" ... "99", two decimal digits per division */
+static const char dec_pairs[200] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+/* Formats v as exactly digits upper case hex digits, or as many as it
+ * needs when digits is 0. buf needs room for sizeof(long) * 2 chars.
+ *
+ * Returns the number of chars written, no terminating NUL is added.
+ */
+size_t fmt_hex(char *buf, unsigned long v, int digits)
+{
+  if (digits <= 0) {
+    unsigned long t = v >> 4;
+    for (digits = 1; t; t >>= 4) {
+      digits++;
+    }
+  }
+  for (int i = digits - 1; i >= 0; i--) {
+    buf[i] = hex_digits[v & 0xf];
+    v >>= 4;
+  }
+  return digits;
+}
+
+/* Formats v in decimal, left padded with '0' to width digits. buf needs
+ * room for max(width, 20) chars.
+ *
+ * Returns the number of chars written, no terminating NUL is added.
+ */
+size_t fmt_udec(char *buf, unsigned long v, int width)
+{
+  char tmp[20];
+  char *p = tmp + sizeof(tmp);
+  size_t n;
+
+  while (v >= 100) {
+    unsigned long q = v / 100;
+    unsigned r = (unsigned)(v - q * 100) * 2;
+    *--p = dec_pairs[r + 1];
+    *--p = dec_pairs[r];
+    v = q;
+  }
+  if (v >= 10) {
+    *--p = dec_pairs[v * 2 + 1];
+    *--p = dec_pairs[v * 2];
+  } else {
+    *--p = '0' + v;
+  }
+
+  n = tmp + sizeof(tmp) - p;
+  if (width > (int)n) {
+    for (int i = 0; i < width - (int)n; i++) {
+      buf[i] = '0';
+    }
+    buf += width - n;
+  }
+  for (size_t i = 0; i < n; i++) {
+    buf[i] = p[i];
+  }
+  return width > (int)n ? (size_t)width : n;
+}
+
+/* Like fmt_udec(), with a leading '-' for negative values that is not
+ * counted in width.
+ */
+size_t fmt_dec(char *buf, long v, int width)
+{
+  if (v < 0) {
+    buf[0] = '-';
+    return 1 + fmt_udec(buf + 1, -(unsigned long)v, width);
+  }
+  return fmt_udec(buf, v, width);
+}
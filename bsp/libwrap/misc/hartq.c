@@ -0,0 +1,29 @@
+/* See LICENSE of license details. */
+
+#include <stdint.h>
+#include "platform.h"
+#include "encoding.h"
+#include "sifive/hartq.h"
+
+void hartq_sleep(hartq_t *const *qs, int n)
+{
+  uintptr_t self = read_csr(mhartid);
+
+  /* mstatus.MIE stays clear, a pending msip only ends the wfi */
+  set_csr(mie, MIP_MSIP);
+  while (1) {
+    /* clear the doorbell before looking, a message published after the
+     * look rings it again. The fence also makes the tails hartq_recv()
+     * left visible before the look, see hartq_send(). */
+    CLINT_REG(CLINT_MSIP + self * CLINT_MSIP_size) = 0;
+    hartq_fence();
+    for (int i = 0; i < n; i++) {
+      if (!hartq_empty(qs[i])) {
+        return;
+      }
+    }
+    while (!(read_csr(mip) & MIP_MSIP)) {
+      __asm__ __volatile__ ("wfi");
+    }
+  }
+}
@@ -0,0 +1,61 @@
+/* See LICENSE of license details. */
+
+#include <stdint.h>
+#include "platform.h"
+#include "encoding.h"
+#include "sifive/smp.h"
+#include "sifive/sync.h"
+
+volatile uint32_t smp_nharts = 1;
+uint32_t smp_release_cycles;
+
+/* set by hart 0 once smp_nharts is final, RAM is only valid after its
+ * bss clear so nothing may be published before the first msip write */
+static volatile uint32_t smp_released;
+static barrier_t smp_boot_barrier = BARRIER_INIT;
+
+void smp_barrier(void)
+{
+  barrier_wait(&smp_boot_barrier, smp_nharts);
+}
+
+static void smp_park(void)
+{
+  while (1) {
+    __asm__ __volatile__ ("wfi");
+  }
+}
+
+/* Hart 0, from smp_resume. Every msip write both wakes a hart and
+ * tells whether it exists: the register of a missing hart reads back
+ * as 0. Each hart only touches its own msip afterwards. */
+void smp_release(void)
+{
+  uint32_t start = read_csr(mcycle);
+  uint32_t n;
+
+  for (n = 1; n < (uintptr_t)__smp_harts; n++) {
+    CLINT_REG(CLINT_MSIP + n * CLINT_MSIP_size) = 1;
+    if (!CLINT_REG(CLINT_MSIP + n * CLINT_MSIP_size)) {
+      break;
+    }
+  }
+  smp_nharts = n;
+  atomic32_store(&smp_released, 1, MO_RELEASE);
+  smp_barrier();
+  smp_release_cycles = read_csr(mcycle) - start;
+}
+
+/* Secondary harts, from start.S once they have a stack */
+void smp_boot_secondary(int hartid)
+{
+  /* hart 0 has to read our msip back before we clear it */
+  while (!atomic32_load(&smp_released, MO_ACQUIRE))
+    ;
+  CLINT_REG(CLINT_MSIP + hartid * CLINT_MSIP_size) = 0;
+  if ((uint32_t)hartid >= smp_nharts) {
+    /* came up behind a missing one, nobody counts on it */
+    smp_park();
+  }
+  smp_barrier();
+}
@@ -0,0 +1,260 @@
+/* See LICENSE of license details. */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "platform.h"
+#include "encoding.h"
+#include "sifive/smp.h"
+#include "sifive/task.h"
+
+/* top is written by thieves, bottom and buf only by the owner, keep
+ * them on separate lines */
+struct task_deque {
+  volatile uint32_t top;
+  uint8_t pad[TASK_CACHE_LINE - sizeof(uint32_t)];
+  volatile uint32_t bottom;
+  task_t *volatile buf[TASK_DEQUE_SIZE];
+} __attribute__((aligned(TASK_CACHE_LINE)));
+
+static struct task_deque deques[TASK_MAX_HARTS];
+
+static volatile uint32_t online_mask = 1;
+static volatile uint32_t active_mask = 1;
+static volatile uint32_t idle_mask;
+
+static int deque_push(struct task_deque *d, task_t *t)
+{
+  uint32_t b = d->bottom;
+  uint32_t top = atomic32_load(&d->top, MO_ACQUIRE);
+
+  if (b - top >= TASK_DEQUE_SIZE) {
+    return 0;
+  }
+  d->buf[b & TASK_DEQUE_MASK] = t;
+  atomic32_store(&d->bottom, b + 1, MO_RELEASE);
+  return 1;
+}
+
+static task_t *deque_pop(struct task_deque *d)
+{
+  uint32_t b = d->bottom - 1;
+  uint32_t top;
+  task_t *t;
+
+  atomic32_store(&d->bottom, b, MO_RELAXED);
+  /* the bottom store has to be visible before top is read, or a thief
+   * and the owner could both take the last task */
+  atomic_fence(MO_SEQ_CST);
+  top = d->top;
+  if ((int32_t)(b - top) < 0) {
+    d->bottom = b + 1;
+    return NULL;
+  }
+  t = d->buf[b & TASK_DEQUE_MASK];
+  if (b == top) {
+    /* last task, race the thieves for it */
+    if (!atomic32_cas(&d->top, &top, top + 1, MO_SEQ_CST)) {
+      t = NULL;
+    }
+    d->bottom = b + 1;
+  }
+  return t;
+}
+
+static task_t *deque_steal(struct task_deque *d)
+{
+  uint32_t top = atomic32_load(&d->top, MO_ACQUIRE);
+  uint32_t b;
+  task_t *t;
+
+  atomic_fence(MO_SEQ_CST);
+  b = atomic32_load(&d->bottom, MO_ACQUIRE);
+  if ((int32_t)(b - top) <= 0) {
+    return NULL;
+  }
+  t = d->buf[top & TASK_DEQUE_MASK];
+  if (!atomic32_cas(&d->top, &top, top + 1, MO_SEQ_CST)) {
+    return NULL;
+  }
+  return t;
+}
+
+static task_t *task_find(int self)
+{
+  task_t *t = deque_pop(&deques[self]);
+  uint32_t victims;
+
+  if (t) {
+    return t;
+  }
+  victims = online_mask & ~(1u << self);
+  for (int i = 1; i < TASK_MAX_HARTS; i++) {
+    int v = (self + i) % TASK_MAX_HARTS;
+
+    if ((victims & (1u << v)) && (t = deque_steal(&deques[v]))) {
+      return t;
+    }
+  }
+  return NULL;
+}
+
+static int task_queued(void)
+{
+  for (int i = 0; i < TASK_MAX_HARTS; i++) {
+    if ((int32_t)(deques[i].bottom - deques[i].top) > 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void task_run(task_t *t)
+{
+  task_group_t *g = t->group;
+
+  t->fn(t->arg);
+  /* t may be gone once pending drops */
+  atomic32_fetch_sub(&g->pending, 1, MO_RELEASE);
+}
+
+static void task_wake_one(void)
+{
+  uint32_t idle;
+  int h;
+
+  /* pairs with the fence in task_sleep(): either the sleeper sees the
+   * new task or we see its idle bit */
+  atomic_fence(MO_SEQ_CST);
+  idle = idle_mask & active_mask;
+  if (!idle) {
+    return;
+  }
+  h = __builtin_ctz(idle);
+  if (atomic32_fetch_and(&idle_mask, ~(1u << h), MO_RELAXED) & (1u << h)) {
+    CLINT_REG(CLINT_MSIP + h * CLINT_MSIP_size) = 1;
+  }
+}
+
+static void task_sleep(int self)
+{
+  uint32_t bit = 1u << self;
+
+  atomic32_fetch_or(&idle_mask, bit, MO_SEQ_CST);
+  if (!(active_mask & bit) || !task_queued()) {
+    /* mstatus.MIE stays clear, a pending msip only ends the wfi */
+    set_csr(mie, MIP_MSIP);
+    while (!(read_csr(mip) & MIP_MSIP)) {
+      __asm__ __volatile__ ("wfi");
+    }
+    CLINT_REG(CLINT_MSIP + self * CLINT_MSIP_size) = 0;
+  }
+  atomic32_fetch_and(&idle_mask, ~bit, MO_RELAXED);
+}
+
+int task_init(void)
+{
+  /* every hart of smp_harts() passes the barrier once, the workers
+   * after setting their online bit */
+  smp_barrier();
+  atomic32_store(&active_mask, online_mask, MO_RELEASE);
+  return __builtin_popcount(online_mask);
+}
+
+void task_worker(int hartid)
+{
+  uint32_t bit = 1u << hartid;
+
+  if (hartid >= TASK_MAX_HARTS) {
+    smp_barrier();
+    while (1) {
+      __asm__ __volatile__ ("wfi");
+    }
+  }
+  atomic32_fetch_or(&online_mask, bit, MO_RELEASE);
+  smp_barrier();
+  while (1) {
+    task_t *t = NULL;
+
+    if (active_mask & bit) {
+      t = task_find(hartid);
+    }
+    if (t) {
+      task_run(t);
+    } else {
+      task_sleep(hartid);
+    }
+  }
+}
+
+void task_set_harts(int n)
+{
+  uint32_t mask = n >= 32 ? ~0u : (1u << n) - 1;
+
+  atomic32_store(&active_mask, online_mask & (mask | 1), MO_RELEASE);
+}
+
+void task_spawn(task_group_t *g, task_t *t, void (*fn)(void *arg), void *arg)
+{
+  t->fn = fn;
+  t->arg = arg;
+  t->group = g;
+  atomic32_fetch_add(&g->pending, 1, MO_RELAXED);
+  if (!deque_push(&deques[read_csr(mhartid)], t)) {
+    task_run(t);
+    return;
+  }
+  task_wake_one();
+}
+
+void task_sync(task_group_t *g)
+{
+  int self = read_csr(mhartid);
+
+  while (atomic32_load(&g->pending, MO_ACQUIRE)) {
+    task_t *t = task_find(self);
+
+    if (t) {
+      task_run(t);
+    }
+  }
+}
+
+struct task_range {
+  void (*body)(int lo, int hi, void *arg);
+  void *arg;
+  int lo, hi, grain;
+};
+
+static void task_range_run(void *p)
+{
+  const struct task_range *r = p;
+  struct task_range upper;
+  task_group_t g = TASK_GROUP_INIT;
+  task_t t;
+
+  if (r->hi - r->lo <= r->grain) {
+    r->body(r->lo, r->hi, r->arg);
+    return;
+  }
+  /* hand the upper half to whoever steals it, keep going on the lower */
+  upper = *r;
+  upper.lo = r->lo + (r->hi - r->lo) / 2;
+  task_spawn(&g, &t, task_range_run, &upper);
+  {
+    struct task_range lower = *r;
+
+    lower.hi = upper.lo;
+    task_range_run(&lower);
+  }
+  task_sync(&g);
+}
+
+void task_parallel_for(int begin, int end, int grain,
+                       void (*body)(int lo, int hi, void *arg), void *arg)
+{
+  struct task_range r = { body, arg, begin, end, grain < 1 ? 1 : grain };
+
+  if (begin < end) {
+    task_range_run(&r);
+  }
+}
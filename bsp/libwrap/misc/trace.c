@@ -0,0 +1,77 @@
+/* See LICENSE of license details. */
+
+#include <stdint.h>
+#include <unistd.h>
+#include "platform.h"
+#include "sifive/trace.h"
+
+struct trace_ring trace_ring = { .words = TRACE_BUF_WORDS };
+
+/* Pops the oldest record into rec, which has room for TRACE_MAX_WORDS.
+ * Only one reader may run at a time.
+ *
+ * Returns the number of words in the record, 0 if there is none or the
+ * oldest one is still being written.
+ */
+int trace_read(uint32_t *rec)
+{
+  uint32_t tail = trace_ring.tail;
+  uint32_t hdr;
+  int n;
+
+  if (tail == trace_ring.head) {
+    return 0;
+  }
+  hdr = atomic32_load(&trace_ring.buf[tail & TRACE_BUF_MASK], MO_ACQUIRE);
+  if (!(hdr & TRACE_HDR_VALID)) {
+    return 0;
+  }
+
+  n = 2 + TRACE_HDR_NARGS(hdr);
+  for (int i = 0; i < n; i++) {
+    rec[i] = trace_ring.buf[(tail + i) & TRACE_BUF_MASK];
+    /* a slot must read as not valid when it becomes a header again */
+    trace_ring.buf[(tail + i) & TRACE_BUF_MASK] = 0;
+  }
+  atomic32_store(&trace_ring.tail, tail + n, MO_RELEASE);
+  return n;
+}
+
+static char *put_hex(char *p, uint32_t v)
+{
+  *p++ = ' ';
+  return p + fmt_hex(p, v, 8);
+}
+
+/* Writes all pending records to stdout, one "@T <words in hex>" line
+ * each, and a "@D <count>" line when records were dropped since the
+ * last drain. Meant for the main loop or a low priority task.
+ */
+void trace_drain(void)
+{
+  static uint32_t reported;
+  uint32_t rec[TRACE_MAX_WORDS];
+  char line[3 + 9 * TRACE_MAX_WORDS + 1];
+  uint32_t dropped = trace_ring.dropped;
+  int n;
+
+  if (dropped != reported) {
+    char *p = put_hex(line + 2, dropped - reported);
+    line[0] = '@';
+    line[1] = 'D';
+    *p++ = '\n';
+    write(STDOUT_FILENO, line, p - line);
+    reported = dropped;
+  }
+
+  while ((n = trace_read(rec)) > 0) {
+    char *p = line + 2;
+    line[0] = '@';
+    line[1] = 'T';
+    for (int i = 0; i < n; i++) {
+      p = put_hex(p, rec[i]);
+    }
+    *p++ = '\n';
+    write(STDOUT_FILENO, line, p - line);
+  }
+}
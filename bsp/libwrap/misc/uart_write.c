@@ -0,0 +1,70 @@
+/* See LICENSE of license details. */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "platform.h"
+#include "encoding.h"
+
+#define UART_TXFIFO_DEPTH 8
+
+/* '\r' of a "\n\r" that a non-blocking write had no room for */
+static int pending_cr;
+
+/* Writes len bytes to UART0, filling the TX FIFO in bursts.
+ *
+ * The TX watermark is set to 1, so UART_IP_TXWM means the FIFO is empty
+ * and a whole FIFO worth of bytes can be written after a single status
+ * read. The shift register still holds the previous byte at that point,
+ * so the line does not go idle between bursts. A FIFO that is neither
+ * empty nor full takes bytes one at a time.
+ *
+ * Interrupts are masked from the status read to the end of each burst,
+ * at most UART_TXFIFO_DEPTH writes, so an interrupt handler that writes
+ * too can neither fill the FIFO under a burst nor split a "\n\r".
+ *
+ * crlf: send "\n\r" for every '\n'.
+ * blocking: wait for FIFO space, otherwise stop when the FIFO is full.
+ * A '\r' that did not fit goes out first on the next call.
+ *
+ * Returns the number of bytes of ptr written.
+ */
+size_t uart_write(const void *ptr, size_t len, int crlf, int blocking)
+{
+  const uint8_t *current = (const uint8_t *)ptr;
+  const uint8_t *end = current + len;
+  uint32_t txctrl = UART0_REG(UART_REG_TXCTRL);
+
+  if ((txctrl & UART_TXWM(0xffff)) != UART_TXWM(1)) {
+    UART0_REG(UART_REG_TXCTRL) = (txctrl & ~UART_TXWM(0xffff)) | UART_TXWM(1);
+  }
+
+  while (current < end || pending_cr) {
+    unsigned long mstatus = clear_csr(mstatus, MSTATUS_MIE);
+    int room;
+
+    if (UART0_REG(UART_REG_IP) & UART_IP_TXWM) {
+      room = UART_TXFIFO_DEPTH;
+    } else if (!(UART0_REG(UART_REG_TXFIFO) & 0x80000000)) {
+      room = 1;
+    } else {
+      room = 0;
+    }
+    for (int n = 0; n < room && (current < end || pending_cr); n++) {
+      if (pending_cr) {
+        UART0_REG(UART_REG_TXFIFO) = '\r';
+        pending_cr = 0;
+      } else {
+        UART0_REG(UART_REG_TXFIFO) = *current;
+        pending_cr = crlf && *current == '\n';
+        current++;
+      }
+    }
+    if (mstatus & MSTATUS_MIE) {
+      set_csr(mstatus, MSTATUS_MIE);
+    }
+    if (!room && !blocking) {
+      break;
+    }
+  }
+  return current - (const uint8_t *)ptr;
+}
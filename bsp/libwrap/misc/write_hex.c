@@ -4,16 +4,29 @@
 #include <unistd.h>
 #include "platform.h"
 
+/* These build the whole number on the stack and hand it to write() in
+ * one call, so they are cheap enough for trap and fault reporting.
+ */
+
 void write_hex(int fd, unsigned long int hex)
 {
-  uint8_t ii;
-  uint8_t jj;
-  char towrite;
-  write(fd , "0x", 2);
-  for (ii = sizeof(unsigned long int) * 2 ; ii > 0; ii--) {
-    jj = ii - 1;
-    uint8_t digit = ((hex & (0xF << (jj*4))) >> (jj*4));
-    towrite = digit < 0xA ? ('0' + digit) : ('A' +  (digit - 0xA));
-    write(fd, &towrite, 1);
-  }
+  char buf[2 + sizeof(unsigned long int) * 2];
+
+  buf[0] = '0';
+  buf[1] = 'x';
+  write(fd, buf, 2 + fmt_hex(buf + 2, hex, sizeof(unsigned long int) * 2));
+}
+
+void write_udec(int fd, unsigned long int dec)
+{
+  char buf[20];
+
+  write(fd, buf, fmt_udec(buf, dec, 0));
+}
+
+void write_dec(int fd, long int dec)
+{
+  char buf[21];
+
+  write(fd, buf, fmt_dec(buf, dec, 0));
 }
@@ -3,6 +3,43 @@
 /* These functions are intended for embedded RV32 systems and are
    obviously incorrect in general. */
 
+#ifdef ENABLE_SMP
+
+#include <stdint.h>
+
+#ifndef LIBWRAP_MALLOC_CHUNK
+#define LIBWRAP_MALLOC_CHUNK 256
+#endif
+
+/* Every hart carves small blocks out of its own chunk of the heap, so
+   only refills and large blocks go through the shared break. */
+static __thread char *cache_ptr;
+static __thread char *cache_end;
+
+void* __wrap_malloc(unsigned long sz)
+{
+  extern void* sbrk(long);
+  char* res;
+
+  sz = (sz + 7) & ~7UL;
+  if (sz > LIBWRAP_MALLOC_CHUNK / 4) {
+    res = sbrk(sz);
+    return (long)res == -1 ? 0 : res;
+  }
+  if (sz > (unsigned long)(cache_end - cache_ptr)) {
+    res = sbrk(LIBWRAP_MALLOC_CHUNK);
+    if ((long)res == -1)
+      return 0;
+    cache_ptr = res;
+    cache_end = res + LIBWRAP_MALLOC_CHUNK;
+  }
+  res = cache_ptr;
+  cache_ptr += sz;
+  return res;
+}
+
+#else
+
 void* __wrap_malloc(unsigned long sz)
 {
   extern void* sbrk(long);
@@ -12,6 +49,8 @@ void* __wrap_malloc(unsigned long sz)
   return res;
 }
 
+#endif
+
 void __wrap_free(void* ptr)
 {
 }
@@ -8,6 +8,8 @@ void __wrap_exit(int code)
 {
   const char message[] = "\nProgam has exited with code:";
 
+  uart_flush();
+
   write(STDERR_FILENO, message, sizeof(message) - 1);
   write_hex(STDERR_FILENO, code);
   write(STDERR_FILENO, "\n", 1);
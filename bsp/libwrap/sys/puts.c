@@ -1,6 +1,7 @@
 /* See LICENSE of license details. */
 
 #include <stdint.h>
+#include <string.h>
 #include <errno.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -9,19 +10,11 @@
 #include "stub.h"
 #include "weak_under_alias.h"
 
+/* through write() so it lands in the stdout buffer in order with
+ * everything else */
 int __wrap_puts(const char *s)
 {
-  while (*s != '\0') {
-    while (UART0_REG(UART_REG_TXFIFO) & 0x80000000) ;
-    UART0_REG(UART_REG_TXFIFO) = *s;
-
-    if (*s == '\n') {
-      while (UART0_REG(UART_REG_TXFIFO) & 0x80000000) ;
-      UART0_REG(UART_REG_TXFIFO) = '\r';
-    }
-
-    ++s;
-  }
+  write(STDOUT_FILENO, s, strlen(s));
 
   return 0;
 }
@@ -9,22 +9,30 @@
 #include "stub.h"
 #include "weak_under_alias.h"
 
-ssize_t __wrap_read(int fd, void* ptr, size_t len)
+/* Returns the bytes waiting in the UART0 RX FIFO without blocking.
+ * Programs with their own receive path (e.g. an interrupt driven ring
+ * buffer, which must be the only reader of the FIFO) override this.
+ */
+ssize_t __attribute__((weak)) __uart_read(void* ptr, size_t len)
 {
   uint8_t * current = (uint8_t *)ptr;
-  volatile uint32_t * uart_rx = (uint32_t *)(UART0_CTRL_ADDR + UART_REG_RXFIFO);
-  volatile uint8_t * uart_rx_cnt = (uint8_t *)(UART0_CTRL_ADDR + UART_REG_RXCTRL + 2);
-
+  volatile int32_t * uart_rx = (int32_t *)(UART0_CTRL_ADDR + UART_REG_RXFIFO);
   ssize_t result = 0;
+  int32_t c;
 
+  while ((current < ((uint8_t *)ptr) + len) && ((c = *uart_rx) >= 0)) {
+    *current++ = (uint8_t)c;
+    result++;
+  }
+  return result;
+}
+
+ssize_t __wrap_read(int fd, void* ptr, size_t len)
+{
   if (isatty(fd)) {
-    for (current = (uint8_t *)ptr;
-        (current < ((uint8_t *)ptr) + len) && (*uart_rx_cnt > 0);
-        current ++) {
-      *current = *uart_rx;
-      result++;
-    }
-    return result;
+    /* show a pending prompt before waiting for input */
+    uart_flush();
+    return __uart_read(ptr, len);
   }
 
   return _stub(EBADF);
@@ -1,18 +1,23 @@
 /* See LICENSE of license details. */
 
 #include <stddef.h>
+#include "sifive/atomic.h"
 #include "weak_under_alias.h"
 
 void *__wrap_sbrk(ptrdiff_t incr)
 {
   extern char _end[];
   extern char _heap_end[];
-  static char *curbrk = _end;
+  static char *volatile curbrk = _end;
+  void *old = atomicptr_load((void *volatile *)&curbrk, MO_RELAXED);
 
-  if ((curbrk + incr < _end) || (curbrk + incr > _heap_end))
-    return NULL - 1;
+  /* harts may move the break concurrently, retry until ours sticks */
+  do {
+    if (((char *)old + incr < _end) || ((char *)old + incr > _heap_end))
+      return NULL - 1;
+  } while (!atomicptr_cas((void *volatile *)&curbrk, &old, (char *)old + incr,
+                          MO_RELAXED));
 
-  curbrk += incr;
-  return curbrk - incr;
+  return old;
 }
 weak_under_alias(sbrk);
@@ -0,0 +1,28 @@
+/* See LICENSE of license details. */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "platform.h"
+#include "weak_under_alias.h"
+
+int __real_setvbuf(FILE* fp, char* buf, int mode, size_t size);
+
+/* stdout is buffered in libwrap (see write.c) and the mode given for it
+ * applies there. newlib keeps its default line buffer in front of it
+ * unless stdout is made unbuffered, so printf still hands over whole
+ * lines instead of going through its unbuffered stack copy.
+ */
+int __wrap_setvbuf(FILE* fp, char* buf, int mode, size_t size)
+{
+  if (fp == stdout) {
+    if (mode != _IONBF && mode != _IOLBF && mode != _IOFBF) {
+      return EOF;
+    }
+    uart_setvbuf(buf, mode, size);
+    return mode == _IONBF ? __real_setvbuf(fp, NULL, _IONBF, 0) : 0;
+  }
+
+  return __real_setvbuf(fp, buf, mode, size);
+}
+weak_under_alias(setvbuf);
@@ -1,31 +1,187 @@
 /* See LICENSE of license details. */
 
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <unistd.h>
 #include <sys/types.h>
 
 #include "platform.h"
+#include "encoding.h"
 #include "stub.h"
 #include "weak_under_alias.h"
+#include "sifive/atomic.h"
+
+#ifndef LIBWRAP_OUTBUF_SIZE
+#define LIBWRAP_OUTBUF_SIZE 256
+#endif
+
+/* Output buffer in front of the UART for stdout. stderr is never
+ * buffered, but flushes stdout first so the two stay in order.
+ *
+ * Every hart buffers into its own block in TLS and hands whole buffers,
+ * so whole lines in the default mode, to the UART under uart_owner. The
+ * buffering mode is shared.
+ *
+ * Interrupts are masked only while the buffer changes, never while the
+ * UART sends, so the receive FIFO keeps being drained. While a flush is
+ * on the way out the buffer is busy, and whatever an interrupt handler
+ * writes meanwhile goes to the UART directly.
+ */
+struct outbuf {
+  char *buf;
+  size_t size;
+  size_t len;
+  int busy;
+  char def[LIBWRAP_OUTBUF_SIZE];
+};
+
+static __thread struct outbuf out;
+static int outbuf_mode = _IOLBF;
+
+static inline char *outbuf_buf(void)
+{
+  return out.buf ? out.buf : out.def;
+}
+
+static inline size_t outbuf_size(void)
+{
+  return out.buf ? out.size : LIBWRAP_OUTBUF_SIZE;
+}
+
+/* Sink for buffered output. Programs with an asynchronous TX path
+ * override this; it has to take all len bytes. It runs with interrupts
+ * enabled, so a handler that prints may enter it again, and has to keep
+ * the bytes of each call in order when that happens (uart_write() masks
+ * interrupts around every FIFO burst for this).
+ */
+size_t __attribute__((weak)) __uart_tx(const void* ptr, size_t len)
+{
+  return uart_write(ptr, len, 1, 1);
+}
+
+#ifdef ENABLE_SMP
+/* mhartid + 1 of the hart writing to the UART. A trap taken while
+ * printing may flush again on the same hart, that must not wait. */
+static volatile uint32_t uart_owner;
+
+static int uart_lock(void)
+{
+  uint32_t me = read_csr(mhartid) + 1;
+  uint32_t free;
+
+  if (uart_owner == me) {
+    return 0;
+  }
+  do {
+    free = 0;
+  } while (!atomic32_cas(&uart_owner, &free, me, MO_ACQUIRE));
+  return 1;
+}
+
+static void uart_unlock(int locked)
+{
+  if (locked) {
+    atomic32_store(&uart_owner, 0, MO_RELEASE);
+  }
+}
+#else
+#define uart_lock() 0
+#define uart_unlock(locked) ((void)(locked))
+#endif
+
+static void uart_tx(const void* ptr, size_t len)
+{
+  int locked = uart_lock();
+
+  __uart_tx(ptr, len);
+  uart_unlock(locked);
+}
+
+static inline void irq_restore(unsigned long mstatus)
+{
+  if (mstatus & MSTATUS_MIE) {
+    set_csr(mstatus, MSTATUS_MIE);
+  }
+}
+
+/* Sends what the calling hart buffered. Called with interrupts masked,
+ * restores them to mstatus while sending and masks them again before it
+ * returns.
+ */
+static void outbuf_flush(unsigned long mstatus)
+{
+  if (!out.len || out.busy) {
+    return;
+  }
+  out.busy = 1;
+  irq_restore(mstatus);
+  uart_tx(outbuf_buf(), out.len);
+  clear_csr(mstatus, MSTATUS_MIE);
+  out.len = 0;
+  out.busy = 0;
+}
+
+/* Writes out everything the calling hart buffered for stdout. Called
+ * from exit, the trap handler and read, safe to call from interrupt
+ * handlers.
+ */
+void uart_flush(void)
+{
+  unsigned long mstatus = clear_csr(mstatus, MSTATUS_MIE);
+
+  outbuf_flush(mstatus);
+  irq_restore(mstatus);
+}
+
+/* Selects the stdout buffering mode, see setvbuf(3). buf may be NULL to
+ * keep the current buffer, otherwise it replaces the one of the calling
+ * hart only.
+ */
+void uart_setvbuf(char* buf, int mode, size_t size)
+{
+  unsigned long mstatus = clear_csr(mstatus, MSTATUS_MIE);
+
+  outbuf_flush(mstatus);
+  if (buf && size) {
+    out.buf = buf;
+    out.size = size;
+  }
+  outbuf_mode = mode;
+  irq_restore(mstatus);
+}
 
 ssize_t __wrap_write(int fd, const void* ptr, size_t len)
 {
-  const uint8_t * current = (const char *)ptr;
+  unsigned long mstatus;
+  int direct;
+
+  if (!isatty(fd)) {
+    return _stub(EBADF);
+  }
 
-  if (isatty(fd)) {
-    for (size_t jj = 0; jj < len; jj++) {
-      while (UART0_REG(UART_REG_TXFIFO) & 0x80000000) ;
-      UART0_REG(UART_REG_TXFIFO) = current[jj];
+  /* interrupt handlers may print too */
+  mstatus = clear_csr(mstatus, MSTATUS_MIE);
 
-      if (current[jj] == '\n') {
-        while (UART0_REG(UART_REG_TXFIFO) & 0x80000000) ;
-        UART0_REG(UART_REG_TXFIFO) = '\r';
-      }
-    }
+  direct = fd != STDOUT_FILENO || outbuf_mode == _IONBF ||
+    len > outbuf_size() || out.busy;
+  if (direct || len > outbuf_size() - out.len) {
+    outbuf_flush(mstatus);
+  }
+  if (direct) {
+    irq_restore(mstatus);
+    uart_tx(ptr, len);
     return len;
   }
 
-  return _stub(EBADF);
+  memcpy(outbuf_buf() + out.len, ptr, len);
+  out.len += len;
+  if (out.len == outbuf_size() ||
+      (outbuf_mode == _IOLBF && memchr(ptr, '\n', len))) {
+    outbuf_flush(mstatus);
+  }
+  irq_restore(mstatus);
+  return len;
 }
 weak_under_alias(write);
@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+# See LICENSE for license details.
+"""Collects benchmark records (see bsp/include/sifive/bench.h) and
+compares them against a baseline.
+
+Records are the {"bench":...} lines a program prints. They are read
+from a console log of a board, or from programs run under QEMU, until
+the {"bench":"_end"} record, the exit message of libwrap or a timeout:
+
+    bench_run.py --log console.log --save hifive1.jsonl
+    bench_run.py --qemu sifive_e --baseline hifive1.jsonl \\
+        software/bench/bench software/coremark/coremark
+
+QEMU's sifive_e machine matches the freedom-e300-hifive1 memory map.
+sifive_u only runs 64 bit programs linked for its memory at 0x80000000.
+QEMU runs with -icount shift=0, one instruction per virtual
+nanosecond, so mcycle and minstret count retired instructions rather
+than host time and repeat from run to run. QEMU does not model the
+pipeline, so under QEMU only instret is compared unless --metrics says
+otherwise.
+
+A metric regresses when it moved the wrong way by more than the
+threshold: cycle and instret counts and cpi must not grow, rates such as
+coremark_per_mhz must not shrink. String fields (the CoreMark CRCs) have
+to match exactly, except crcfinal: it accumulates over all iterations,
+so it is only compared when both runs did the same number. The exit
+status is 1 if anything regressed or a benchmark of the baseline is
+missing.
+"""
+
+import argparse
+import json
+import os
+import select
+import subprocess
+import sys
+import time
+
+END = '_end'
+EXIT_MESSAGE = 'Progam has exited with code:'
+
+QEMU = {
+    'sifive_e': 'qemu-system-riscv32',
+    'sifive_u': 'qemu-system-riscv64',
+}
+
+
+def parse_line(line):
+    """The record on a console line, None for other output."""
+    start = line.find('{"bench":')
+    if start < 0:
+        return None
+    try:
+        return json.loads(line[start:])
+    except ValueError:
+        return None
+
+
+def read_records(lines):
+    records = []
+    for line in lines:
+        rec = parse_line(line)
+        if rec is not None:
+            if rec['bench'] == END:
+                break
+            records.append(rec)
+        elif EXIT_MESSAGE in line:
+            break
+    return records
+
+
+def qemu_lines(machine, elf, timeout):
+    """Console lines of elf running on machine, until timeout seconds."""
+    cmd = [QEMU[machine], '-M', machine, '-nographic', '-bios', 'none',
+           '-icount', 'shift=0', '-kernel', elf]
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                            stdin=subprocess.DEVNULL)
+    deadline = time.monotonic() + timeout
+    pending = b''
+    try:
+        while True:
+            left = deadline - time.monotonic()
+            if left <= 0 or not select.select([proc.stdout], [], [], left)[0]:
+                sys.stderr.write('%s: timed out\n' % elf)
+                return
+            chunk = os.read(proc.stdout.fileno(), 4096)
+            if not chunk:
+                return
+            pending += chunk
+            while b'\n' in pending:
+                line, pending = pending.split(b'\n', 1)
+                yield line.decode('utf-8', 'replace')
+    finally:
+        proc.kill()
+        proc.wait()
+
+
+def load(path):
+    with open(path) as f:
+        return [json.loads(line) for line in f if line.strip()]
+
+
+def key(rec):
+    """Records of the same benchmark and CoreMark run are compared."""
+    return rec['bench'] + ('/' + rec['run'] if 'run' in rec else '')
+
+
+def direction(metric):
+    """-1 if smaller is better, +1 if larger is better, 0 to skip."""
+    if metric.startswith(('cycles', 'instret', 'cpi')):
+        return -1
+    if '_per_' in metric and not metric.startswith('cycles'):
+        return 1
+    return 0
+
+
+def comparable(metric, base, rec):
+    """False for fields that depend on how long the run was."""
+    if metric == 'crcfinal':
+        return base.get('iterations') == rec.get('iterations')
+    return True
+
+
+def compare(baseline, results, threshold, metrics):
+    current = {key(r): r for r in results}
+    failures = 0
+    for base in baseline:
+        name = key(base)
+        rec = current.get(name)
+        if rec is None:
+            print('%-24s missing' % name)
+            failures += 1
+            continue
+        if base.get('skipped') or rec.get('skipped'):
+            continue
+        for metric, old in base.items():
+            if metric == 'bench' or metric not in rec:
+                continue
+            if not comparable(metric, base, rec):
+                continue
+            if metrics and metric not in metrics and not isinstance(old, str):
+                continue
+            new = rec[metric]
+            if isinstance(old, str):
+                if old != new and metric != 'unit':
+                    print('%-24s %-18s %s != %s' % (name, metric, new, old))
+                    failures += 1
+                continue
+            sense = direction(metric)
+            if not sense or isinstance(old, bool) or not old:
+                continue
+            change = (new - old) * 100.0 / old
+            bad = change * sense < -threshold
+            print('%-24s %-18s %14s %14s %+7.2f%%%s' % (
+                name, metric, old, new, change, '  REGRESSION' if bad else ''))
+            failures += bad
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('elf', nargs='*', help='programs to run under QEMU')
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--log', help="console log of a board, '-' for stdin")
+    source.add_argument('--qemu', choices=sorted(QEMU), help='QEMU machine')
+    parser.add_argument('--timeout', type=float, default=120,
+                        help='seconds per program under QEMU (%(default)s)')
+    parser.add_argument('--save', help='write the records to this file')
+    parser.add_argument('--baseline', help='records to compare against')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='noise threshold in percent (%(default)s)')
+    parser.add_argument('--metrics',
+                        help='comma separated metrics to compare, default all'
+                             ' (instret under QEMU)')
+    args = parser.parse_args()
+
+    if args.log:
+        with (sys.stdin if args.log == '-' else open(args.log)) as f:
+            results = read_records(f)
+    else:
+        if not args.elf:
+            parser.error('--qemu needs at least one program')
+        results = []
+        for elf in args.elf:
+            results += read_records(qemu_lines(args.qemu, elf, args.timeout))
+
+    if args.save:
+        with open(args.save, 'w') as f:
+            for rec in results:
+                f.write(json.dumps(rec, separators=(',', ':')) + '\n')
+    if not args.baseline:
+        for rec in results:
+            print(json.dumps(rec, separators=(',', ':')))
+        return 0
+
+    if args.metrics:
+        metrics = set(args.metrics.split(','))
+    elif args.qemu:
+        metrics = {'instret'}
+    else:
+        metrics = set()
+    failures = compare(load(args.baseline), results, args.threshold, metrics)
+    print('%d benchmarks, %d regressions' % (len(results), failures))
+    return 1 if failures else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+# See LICENSE for license details.
+"""Decodes TRACE() records (see bsp/include/sifive/trace.h).
+
+Reads console output containing "@T"/"@D" lines from trace_drain(), or a
+raw dump of the trace_ring structure taken by a debugger, e.g.
+
+    (gdb) dump binary value ring.bin trace_ring
+
+and prints every record with its format string from the program's ELF.
+Other console lines are passed through unchanged.
+
+    trace_decode.py software/watchdog/watchdog < console.log
+    trace_decode.py --ring ring.bin software/watchdog/watchdog
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+HDR_VALID = 0x80000000
+
+
+class Elf:
+    """Just enough of ELF32/ELF64 little endian to read sections."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF' or self.data[5] != 1:
+            sys.exit('%s: not a little endian ELF file' % path)
+        if self.data[4] == 1:
+            shoff, = struct.unpack_from('<I', self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data, 0x2e)
+            fmt = '<IIIIIIIIII'
+        else:
+            shoff, = struct.unpack_from('<Q', self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from('<HHH', self.data, 0x3a)
+            fmt = '<IIQQQQIIQQ'
+        headers = [struct.unpack_from(fmt, self.data, shoff + i * shentsize)
+                   for i in range(shnum)]
+        strtab = headers[shstrndx]
+        self.sections = []
+        for name, stype, flags, addr, offset, size in (h[:6] for h in headers):
+            end = self.data.index(b'\0', strtab[4] + name)
+            sname = self.data[strtab[4] + name:end].decode()
+            body = self.data[offset:offset + size] if stype != 8 else b''
+            self.sections.append((sname, flags, addr, body))
+
+    def section(self, name):
+        for sname, _, _, body in self.sections:
+            if sname == name:
+                return body
+        return None
+
+    def string_at(self, addr):
+        """C string at a load address, from any allocated section."""
+        for _, flags, start, body in self.sections:
+            if flags & 2 and start <= addr < start + len(body):
+                off = addr - start
+                return body[off:body.index(b'\0', off)].decode(errors='replace')
+        return '<%#x>' % addr
+
+
+CONV = re.compile(r'%([-+ 0#]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|z)?([diuxXocsp%])')
+
+
+def format_record(elf, fmts, words):
+    hdr, stamp, args = words[0], words[1], list(words[2:])
+    fid = hdr & 0xffffff
+    if fid >= len(fmts):
+        return '[%10u] <unknown trace id %#x> %s' % (
+            stamp, fid, ' '.join('%#x' % a for a in args))
+    fmt = fmts[fid:fmts.index(b'\0', fid)].decode(errors='replace')
+
+    def conv(m):
+        flags, width, prec, _, c = m.groups()
+        if c == '%':
+            return '%'
+        if width == '*':
+            width = str(args.pop(0))
+        if prec == '*':
+            prec = str(args.pop(0))
+        v = args.pop(0) if args else 0
+        spec = '%' + flags + (width or '') + ('.' + prec if prec else '')
+        if c in 'di':
+            return (spec + 'd') % (v - (1 << 32) if v & 0x80000000 else v)
+        if c == 'u':
+            return (spec + 'd') % v
+        if c == 'c':
+            return (spec + 'c') % chr(v & 0xff)
+        if c == 's':
+            return (spec + 's') % elf.string_at(v)
+        if c == 'p':
+            return (spec + 's') % ('%#x' % v)
+        return (spec + c) % v
+
+    return '[%10u] %s' % (stamp, CONV.sub(conv, fmt).rstrip('\n'))
+
+
+def decode_console(elf, fmts, lines):
+    for line in lines:
+        fields = line.split()
+        if fields[:1] == ['@T']:
+            print(format_record(elf, fmts, [int(w, 16) for w in fields[1:]]))
+        elif fields[:1] == ['@D']:
+            print('<%d trace records dropped>' % int(fields[1], 16))
+        else:
+            sys.stdout.write(line)
+
+
+def decode_ring(elf, fmts, path):
+    with open(path, 'rb') as f:
+        raw = f.read()
+    words, head, tail, dropped = struct.unpack_from('<IIII', raw)
+    buf = struct.unpack_from('<%dI' % words, raw, 16)
+    while tail != head:
+        hdr = buf[tail % words]
+        if not hdr & HDR_VALID:
+            break
+        n = 2 + ((hdr >> 24) & 0x7)
+        print(format_record(elf, fmts, [buf[(tail + i) % words] for i in range(n)]))
+        tail = (tail + n) & 0xffffffff
+    if dropped:
+        print('<%d trace records dropped>' % dropped)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('elf', help='program ELF built by "make software"')
+    parser.add_argument('log', nargs='?', help='console log (default: stdin)')
+    parser.add_argument('--ring', help='raw dump of trace_ring')
+    opts = parser.parse_args()
+
+    elf = Elf(opts.elf)
+    fmts = elf.section('.trace_fmt')
+    if fmts is None:
+        sys.exit('%s: no .trace_fmt section' % opts.elf)
+
+    if opts.ring:
+        decode_ring(elf, fmts, opts.ring)
+    elif opts.log:
+        with open(opts.log) as f:
+            decode_console(elf, fmts, f)
+    else:
+        decode_console(elf, fmts, sys.stdin)
+
+
+if __name__ == '__main__':
+    main()
@@ -2,6 +2,7 @@
 
 unset board
 unset manual
+unset qemu
 while [[ "$1" != "" ]]
 do
   case "$1" in
@@ -14,6 +15,11 @@ do
     manual="true"
     shift
     ;;
+  "--qemu")
+    qemu="$2"
+    shift
+    shift
+    ;;
   esac
 done
 
@@ -65,6 +71,13 @@ do
   fi
 done
 
+# Benchmarks run unattended under QEMU, against the board's baseline in
+# software/bench/baselines if there is one.
+if [[ "$qemu" != "" ]]
+then
+  make BOARD=$board QEMU_MACHINE=$qemu bench_qemu
+fi
+
 if [[ "$manual" != "true" ]]
 then
   echo "You haven't actually verified the tests run, please don't release!" >&2
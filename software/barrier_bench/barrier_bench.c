@@ -0,0 +1,140 @@
+// See LICENSE for license details.
+
+// Cost of releasing and synchronizing the harts. Prints
+//  - the boot release as measured by smp_release(),
+//  - the same release repeated after boot, once with the msip
+//    scheme smp_resume used before (hart 0 raises msip for all
+//    MAX_HARTS, then every hart polls every msip word until they are
+//    clear) and once with the current one (msip per running
+//    hart, then the RAM barrier),
+//  - a barrier_wait() round for 1 .. smp_harts() harts.
+// Build with SMP_HARTS=1, 4 and 8 to compare hart counts:
+//   make software PROGRAM=barrier_bench SMP_HARTS=8
+
+#include <stdio.h>
+#include <stdint.h>
+#include "platform.h"
+#include "encoding.h"
+#include "sifive/smp.h"
+#include "sifive/sync.h"
+
+#define ROUNDS 100
+
+#define MSIP(h) CLINT_REG(CLINT_MSIP + (h) * CLINT_MSIP_size)
+
+enum { RELEASE_LEGACY, RELEASE_BARRIER };
+
+static barrier_t bar = BARRIER_INIT;
+static volatile uint32_t mode;
+
+static void wait_msip(void)
+{
+  while (!(read_csr(mip) & MIP_MSIP)) {
+    __asm__ __volatile__ ("wfi");
+  }
+}
+
+static void release_legacy(int hartid)
+{
+  if (hartid == 0) {
+    for (int h = 0; h < MAX_HARTS; h++) {
+      MSIP(h) = 1;
+    }
+  }
+  wait_msip();
+  MSIP(hartid) = 0;
+  /* the old loop polled all MAX_HARTS words, which only terminates
+   * when no parked hart exists above SMP_HARTS */
+  for (int h = 0; h < smp_harts(); h++) {
+    while (MSIP(h))
+      ;
+  }
+  if (hartid == 0) {
+    for (int h = smp_harts(); h < MAX_HARTS; h++) {
+      MSIP(h) = 0;
+    }
+  }
+}
+
+static void release_barrier(int hartid)
+{
+  if (hartid == 0) {
+    for (int h = 1; h < smp_harts(); h++) {
+      MSIP(h) = 1;
+    }
+  } else {
+    wait_msip();
+    MSIP(hartid) = 0;
+  }
+  smp_barrier();
+}
+
+static void release(int hartid, int how)
+{
+  if (how == RELEASE_LEGACY) {
+    release_legacy(hartid);
+  } else {
+    release_barrier(hartid);
+  }
+}
+
+static void bench(int hartid)
+{
+  uint32_t harts = smp_harts();
+
+  set_csr(mie, MIP_MSIP);
+  if (hartid == 0) {
+    printf("%u harts, boot release %u cycles\n", (unsigned)harts,
+           (unsigned)smp_release_cycles);
+  }
+
+  for (int how = RELEASE_LEGACY; how <= RELEASE_BARRIER; how++) {
+    uint32_t total = 0;
+
+    for (int i = 0; i < ROUNDS; i++) {
+      uint32_t start;
+
+      /* everybody asleep or about to be before hart 0 lets go */
+      smp_barrier();
+      start = read_csr(mcycle);
+      release(hartid, how);
+      total += read_csr(mcycle) - start;
+    }
+    if (hartid == 0) {
+      printf("%-8s release %8u cycles\n",
+             how == RELEASE_LEGACY ? "msip" : "barrier",
+             (unsigned)(total / ROUNDS));
+    }
+  }
+
+  for (uint32_t n = 1; n <= harts; n++) {
+    uint32_t start = 0;
+
+    smp_barrier();
+    if ((uint32_t)hartid < n) {
+      start = read_csr(mcycle);
+      for (int i = 0; i < ROUNDS; i++) {
+        barrier_wait(&bar, n);
+      }
+      if (hartid == 0) {
+        printf("barrier_wait %2u harts %6u cycles\n", (unsigned)n,
+               (unsigned)((read_csr(mcycle) - start) / ROUNDS));
+      }
+    }
+  }
+  smp_barrier();
+}
+
+int secondary_main(int hartid)
+{
+  bench(hartid);
+  while (1) {
+    __asm__ __volatile__ ("wfi");
+  }
+}
+
+int main()
+{
+  bench(0);
+  return 0;
+}
@@ -0,0 +1,24 @@
+// See LICENSE for license details.
+
+// malloc() and free() from libwrap. free() does not return memory, so
+// every run takes ALLOCS * SIZE bytes of the heap for good.
+
+#include <stdlib.h>
+#include "sifive/bench.h"
+
+#define ALLOCS 16
+#define SIZE 16
+
+BENCH(malloc_16, .ops = ALLOCS, .unit = "alloc")
+{
+  void *p[ALLOCS];
+
+  for (int i = 0; i < ALLOCS; i++) {
+    p[i] = malloc(SIZE);
+  }
+  bench_pause(b);
+  for (int i = 0; i < ALLOCS; i++) {
+    free(p[i]);
+  }
+  bench_resume(b);
+}
@@ -0,0 +1,14 @@
+// See LICENSE for license details.
+
+// Runs every benchmark linked into the program and prints one JSON line
+// for each, see sifive/bench.h. bsp/tools/bench_run.py collects the
+// lines and compares them against a baseline.
+
+#include "sifive/bench.h"
+
+int main()
+{
+  bench_run_all();
+  bench_end();
+  return 0;
+}
@@ -0,0 +1,39 @@
+// See LICENSE for license details.
+
+// Cycles from raising a software interrupt with an msip store until the
+// first instruction of its handler, with mtvec in direct mode.
+
+#include <stdint.h>
+#include "platform.h"
+#include "encoding.h"
+#include "sifive/bench.h"
+
+static volatile uint32_t raised, entered;
+
+static void __attribute__((interrupt, aligned(64))) msip_handler(void)
+{
+  entered = read_csr(mcycle);
+  CLINT_REG(CLINT_MSIP) = 0;
+}
+
+BENCH(irq_latency, .reps = 16, .unit = "irq")
+{
+  uintptr_t mtvec, mie;
+
+  bench_pause(b);
+  mtvec = read_csr(mtvec);
+  mie = read_csr(mie);
+  entered = 0;
+  write_csr(mtvec, (uintptr_t)&msip_handler);
+  write_csr(mie, MIP_MSIP);
+  set_csr(mstatus, MSTATUS_MIE);
+  raised = read_csr(mcycle);
+  CLINT_REG(CLINT_MSIP) = 1;
+  while (!entered)
+    ;
+  clear_csr(mstatus, MSTATUS_MIE);
+  write_csr(mie, mie);
+  write_csr(mtvec, mtvec);
+  bench_set_cycles(b, entered - raised);
+  bench_resume(b);
+}
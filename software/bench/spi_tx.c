@@ -0,0 +1,53 @@
+// See LICENSE for license details.
+
+// SPI1 transmit throughput at the fastest serial clock. Chip select is
+// off and the pins stay on GPIO, so nothing outside the chip sees the
+// traffic. SPI0 is not touched, it feeds the XIP flash.
+
+#include <stdint.h>
+#include "platform.h"
+#include "sifive/bench.h"
+
+#define BYTES 64
+
+/* polls before deciding the controller is not there, e.g. in QEMU */
+#define SPI_TIMEOUT 100000
+
+BENCH(spi1_tx, .ops = BYTES, .unit = "byte")
+{
+#ifdef SPI1_CTRL_ADDR
+  uint32_t sckdiv = SPI1_REG(SPI_REG_SCKDIV);
+  uint32_t csmode = SPI1_REG(SPI_REG_CSMODE);
+  uint32_t fmt = SPI1_REG(SPI_REG_FMT);
+  uint32_t txctrl = SPI1_REG(SPI_REG_TXCTRL);
+  int polls = 0;
+
+  bench_pause(b);
+  SPI1_REG(SPI_REG_SCKDIV) = 0;
+  SPI1_REG(SPI_REG_CSMODE) = SPI_CSMODE_OFF;
+  SPI1_REG(SPI_REG_FMT) = SPI_FMT_PROTO(SPI_PROTO_S) |
+                          SPI_FMT_ENDIAN(SPI_ENDIAN_MSB) |
+                          SPI_FMT_DIR(SPI_DIR_TX) | SPI_FMT_LEN(8);
+  /* txwm pending means the FIFO is empty */
+  SPI1_REG(SPI_REG_TXCTRL) = SPI_TXWM(1);
+  bench_resume(b);
+  for (int i = 0; i < BYTES; i++) {
+    while (SPI1_REG(SPI_REG_TXFIFO) & SPI_TXFIFO_FULL)
+      ;
+    SPI1_REG(SPI_REG_TXFIFO) = (uint8_t)i;
+  }
+  while (!(SPI1_REG(SPI_REG_IP) & SPI_IP_TXWM) && ++polls < SPI_TIMEOUT)
+    ;
+  bench_pause(b);
+  if (polls == SPI_TIMEOUT) {
+    bench_skip(b);
+  }
+  SPI1_REG(SPI_REG_TXCTRL) = txctrl;
+  SPI1_REG(SPI_REG_FMT) = fmt;
+  SPI1_REG(SPI_REG_CSMODE) = csmode;
+  SPI1_REG(SPI_REG_SCKDIV) = sckdiv;
+  bench_resume(b);
+#else
+  bench_skip(b);
+#endif
+}
@@ -0,0 +1,28 @@
+// See LICENSE for license details.
+
+// UART0 transmit throughput: one line through uart_write() until the TX
+// FIFO has drained, at the baud rate _init() set up.
+
+#include <stdint.h>
+#include "platform.h"
+#include "sifive/bench.h"
+
+#define LINE 64
+
+BENCH(uart_tx, .ops = LINE, .unit = "byte")
+{
+  static const char line[LINE] =
+    "uart_tx ..................................................... \n";
+
+  bench_pause(b);
+  uart_flush();
+  /* as uart_write() sets it, txwm pending means the FIFO is empty */
+  UART0_REG(UART_REG_TXCTRL) =
+    (UART0_REG(UART_REG_TXCTRL) & ~UART_TXWM(0xffff)) | UART_TXWM(1);
+  while (!(UART0_REG(UART_REG_IP) & UART_IP_TXWM))
+    ;
+  bench_resume(b);
+  uart_write(line, LINE, 0, 1);
+  while (!(UART0_REG(UART_REG_IP) & UART_IP_TXWM))
+    ;
+}
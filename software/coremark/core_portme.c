@@ -3,6 +3,8 @@
 #include "coremark.h"
 #include "platform.h"
 #include "encoding.h"
+#include "sifive/bench.h"
+#include "sifive/bsp_printf.h"
 
 #if VALIDATION_RUN
 	volatile ee_s32 seed1_volatile=0x3415;
@@ -25,16 +27,32 @@
 volatile ee_s32 seed4_volatile=ITERATIONS;
 volatile ee_s32 seed5_volatile=0;
 
+/* mcycle runs at the core clock on every board, mtime only at 32 kHz
+ * on the HiFive1 */
+static CORE_TICKS read_cycles(void)
+{
+#if __riscv_xlen == 32
+  while (1) {
+    uint32_t hi = read_csr(mcycleh);
+    uint32_t lo = read_csr(mcycle);
+    if (hi == read_csr(mcycleh))
+      return ((uint64_t)hi << 32) | lo;
+  }
+#else
+  return read_csr(mcycle);
+#endif
+}
+
 static CORE_TICKS t0, t1;
 
 void start_time(void)
 {
-  t0 = get_timer_value();
+  t0 = read_cycles();
 }
 
 void stop_time(void)
 {
-  t1 = get_timer_value();
+  t1 = read_cycles();
 }
 
 CORE_TICKS get_time(void)
@@ -44,9 +62,164 @@ CORE_TICKS get_time(void)
 
 secs_ret time_in_secs(CORE_TICKS ticks)
 {
-  // scale timer down to avoid uint64_t -> double conversion in RV32
-  int scale = 256;
-  uint32_t delta = ticks / scale;
-  uint32_t freq = get_timer_freq() / scale;
-  return delta / (double)freq;
+  return ticks / (secs_ret)get_cpu_freq();
+}
+
+#if PROFILE_RUN
+#define RUN_NAME "profile"
+#elif VALIDATION_RUN
+#define RUN_NAME "validation"
+#else
+#define RUN_NAME "performance"
+#endif
+
+static void record_crc(const char *key, ee_u16 crc)
+{
+  char hex[8];
+
+  bsp_snprintf(hex, sizeof(hex), "0x%04x", crc);
+  bench_record_str(key, hex);
+}
+
+static void report_json(const core_results *res)
+{
+  CORE_TICKS ticks = get_time();
+  uint64_t iterations = (uint64_t)res->iterations * default_num_contexts;
+  /* CoreMark/MHz is iterations per million cycles, whatever the clock */
+  uint64_t per_mhz = ticks ? iterations * 1000000000ull / ticks : 0;
+
+  bench_record_begin("coremark");
+  bench_record_str("run", RUN_NAME);
+  bench_record_u64("size", res->size);
+  bench_record_u64("contexts", default_num_contexts);
+  bench_record_u64("iterations", res->iterations);
+  bench_record_u64("cycles", ticks);
+  bench_record_u64("cpu_freq", get_cpu_freq());
+  bench_record_fixed("coremark_per_mhz", per_mhz, 3);
+  record_crc("crclist", res->crclist);
+  record_crc("crcmatrix", res->crcmatrix);
+  record_crc("crcstate", res->crcstate);
+  record_crc("crcfinal", res->crc);
+  bench_record_end();
+  bench_end();
+}
+
+/* core_main.c hands us results[0].port */
+static const core_results *port_results(const core_portable *p)
+{
+  return (const core_results *)((const char *)p -
+                                offsetof(core_results, port));
+}
+
+#if (MULTITHREAD==1)
+void portable_init(core_portable *p, int *argc, char *argv[])
+{
+}
+
+void portable_fini(core_portable *p)
+{
+  report_json(port_results(p));
+}
+#endif
+
+#if (MULTITHREAD>1)
+#include "sifive/atomic.h"
+#include "sifive/hartq.h"
+#include "sifive/smp.h"
+
+ee_u32 default_num_contexts = 1;
+
+static hartq_t runq[MULTITHREAD];
+static core_results *contexts[MULTITHREAD];
+
+void *portable_malloc(ee_size_t size)
+{
+  return malloc(size);
+}
+
+void portable_free(void *p)
+{
+  free(p);
 }
+
+void portable_init(core_portable *p, int *argc, char *argv[])
+{
+  int harts = smp_harts();
+
+  default_num_contexts = harts < MULTITHREAD ? harts : MULTITHREAD;
+  for (int i = 0; i < MULTITHREAD; i++) {
+    runq[i].consumer = i;
+  }
+}
+
+static void run_context(core_results *res)
+{
+  res->port.start = read_cycles();
+  iterate(res);
+  res->port.stop = read_cycles();
+  atomic32_store(&res->port.done, 1, MO_RELEASE);
+}
+
+/* Called on hart 0 for every context before the first
+ * core_stop_parallel(). Context 0 is kept for hart 0 itself, it runs
+ * once the others are on their way. */
+ee_u8 core_start_parallel(core_results *res)
+{
+  static ee_u32 next;
+  ee_u32 hart = next++;
+
+  res->port.hart = hart;
+  res->port.done = 0;
+  contexts[hart] = res;
+  if (hart != 0) {
+    while (!hartq_send(&runq[hart], (uintptr_t)res))
+      ;
+  }
+  return 0;
+}
+
+ee_u8 core_stop_parallel(core_results *res)
+{
+  if (res->port.hart == 0) {
+    run_context(res);
+  }
+  while (!atomic32_load(&res->port.done, MO_ACQUIRE))
+    ;
+  return 0;
+}
+
+int secondary_main(int hartid)
+{
+  hartq_t *q;
+
+  if (hartid >= MULTITHREAD) {
+    while (1) {
+      __asm__ __volatile__ ("wfi");
+    }
+  }
+  q = &runq[hartid];
+  while (1) {
+    uintptr_t msg;
+
+    hartq_sleep(&q, 1);
+    while (hartq_recv(q, &msg)) {
+      run_context((core_results *)msg);
+    }
+  }
+}
+
+/* core_main.c only reports the combined rate, add what each hart took */
+void portable_fini(core_portable *p)
+{
+  for (ee_u32 i = 0; i < default_num_contexts; i++) {
+    const core_portable *port = &contexts[i]->port;
+    CORE_TICKS ticks = port->stop - port->start;
+
+    ee_printf("Hart %lu ticks      : %llu\n", (long unsigned)port->hart,
+              (unsigned long long)ticks);
+    ee_printf("Hart %lu iter/sec   : %f\n", (long unsigned)port->hart,
+              contexts[i]->iterations / time_in_secs(ticks));
+  }
+  report_json(port_results(p));
+}
+#endif
@@ -10,6 +10,7 @@
 #define HAS_STDIO 1
 #define HAS_PRINTF 1
 #define SEED_METHOD SEED_VOLATILE
+/* ticks are mcycles, timed at the frequency get_cpu_freq() reports */
 #define CORE_TICKS uint64_t
 #define ee_u8 uint8_t
 #define ee_u16 uint16_t
@@ -28,22 +29,50 @@
 # error
 #endif
 
-#define MEM_METHOD MEM_STACK
-#define MEM_LOCATION "STACK"
-
 #define MAIN_HAS_NOARGC 0
 #define MAIN_HAS_NORETURN 0
 
+/* MULTITHREAD > 1 (set from the Makefile) runs one context per hart of
+ * an ENABLE_SMP build, up to MULTITHREAD of them. Context 0 runs on
+ * hart 0 and context i on hart i, the others take their work from a
+ * hartq ring (sifive/hartq.h) in secondary_main(). */
+#ifndef MULTITHREAD
 #define MULTITHREAD 1
+#endif
 #define USE_PTHREAD 0
 #define USE_FORK 0
 #define USE_SOCKET 0
 
+#if (MULTITHREAD>1)
+
+/* hart 0's stack is too small for a data block per context */
+#define MEM_METHOD MEM_MALLOC
+#define MEM_LOCATION "HEAP"
+
+#define PARALLEL_METHOD "Harts"
+
+extern ee_u32 default_num_contexts;
+
+#else
+
+#define MEM_METHOD MEM_STACK
+#define MEM_LOCATION "STACK"
+
 #define default_num_contexts MULTITHREAD
 
-typedef int core_portable;
-static void portable_init(core_portable *p, int *argc, char *argv[]) {}
-static void portable_fini(core_portable *p) {}
+#endif
+
+/* start and stop are the mcycle values of the hart running the context */
+typedef struct {
+  volatile ee_u32 done;
+  ee_u32 hart;
+  CORE_TICKS start, stop;
+} core_portable;
+
+/* portable_fini() prints the run as one JSON line starting with
+ * {"bench":"coremark", for scripts that track results */
+void portable_init(core_portable *p, int *argc, char *argv[]);
+void portable_fini(core_portable *p);
 
 #if !defined(PROFILE_RUN) && !defined(PERFORMANCE_RUN) && !defined(VALIDATION_RUN)
 #if (TOTAL_DATA_SIZE==1200)
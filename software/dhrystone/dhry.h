@@ -162,6 +162,11 @@
  *                      run this program, which will (erroneously) include
  *                      the time to allocate storage (malloc) and to perform
  *                      the initialization.
+ *              -DMCYCLE
+ *                      Counts mcycle and minstret around the runs with
+ *                      dhry_begin() and dhry_end() from dhry_stubs.c.
+ *                      0 runs calibrates the count, dhry_report()
+ *                      prints DMIPS/MHz and CPI.
  *              -DHZ=nnn
  *                      In Berkeley UNIX, the function "times" returns process
  *                      time in 1/HZ seconds, with HZ = 60 for most systems.
@@ -347,7 +352,7 @@
 
 /* Compiler and system dependent definitions: */
 
-#ifndef TIME
+#if !defined(TIME) && !defined(MCYCLE)
 #define TIMES
 #endif
                 /* Use times(2) time function unless    */
@@ -56,6 +56,13 @@ extern long     time();
 #define Too_Small_Time 2
                 /* Measurements should last at least 2 seconds */
 #endif
+#ifdef MCYCLE
+extern void     dhry_begin(), dhry_end(), dhry_report();
+extern int      dhry_calibrate();
+                /* see dhry_stubs.c */
+#define Pilot_Runs 1000
+int             Calibrate;
+#endif
 
 long            Begin_Time,
                 End_Time,
@@ -122,12 +129,22 @@ main ()
   }
   printf ("\n");
 
+#ifdef MCYCLE
+  Calibrate = Number_Of_Runs <= 0;
+  if (Calibrate)
+    Number_Of_Runs = Pilot_Runs;
+Measure:
+  if (!Calibrate)
+#endif
   printf ("Execution starts, %d runs through Dhrystone\n", Number_Of_Runs);
 
   /***************/
   /* Start timer */
   /***************/
  
+#ifdef MCYCLE
+  dhry_begin ();
+#endif
 #ifdef TIMES
   times (&time_info);
   Begin_Time = (long) time_info.tms_utime;
@@ -193,6 +210,17 @@ main ()
 #ifdef TIME
   End_Time = time ( (long *) 0);
 #endif
+#ifdef MCYCLE
+  dhry_end ();
+  if (Calibrate)
+  {
+    /* the pilot runs only size the real measurement */
+    Calibrate = false;
+    Number_Of_Runs = dhry_calibrate (Number_Of_Runs);
+    Arr_2_Glob [8][7] = 10;
+    goto Measure;
+  }
+#endif
 
   printf ("Execution ends\n");
   printf ("\n");
@@ -247,6 +275,9 @@ main ()
   printf ("        should be:   DHRYSTONE PROGRAM, 2'ND STRING\n");
   printf ("\n");
 
+#ifdef MCYCLE
+  dhry_report (Number_Of_Runs);
+#else
   User_Time = End_Time - Begin_Time;
 
   if (User_Time < Too_Small_Time)
@@ -273,6 +304,7 @@ main ()
     printf ("%6.1f \n", Dhrystones_Per_Second);
     printf ("\n");
   }
+#endif
   
 }
 
@@ -1,8 +1,23 @@
+#include <stdint.h>
 #include "platform.h"
+#include "sifive/bench.h"
+#include "sifive/bsp_printf.h"
 
 /* The functions in this file are only meant to support Dhrystone on an
  * embedded RV32 system and are obviously incorrect in general. */
 
+/* Number of runs, 0 to calibrate it to about DHRY_SECONDS */
+#ifndef DHRY_RUNS
+#define DHRY_RUNS 0
+#endif
+
+#ifndef DHRY_SECONDS
+#define DHRY_SECONDS 2
+#endif
+
+/* Dhrystones per second of the VAX 11/780, the 1 MIPS machine */
+#define VAX_DHRYSTONES 1757
+
 long time(void)
 {
   return get_timer_value() / get_timer_freq();
@@ -11,5 +26,65 @@ long time(void)
 // set the number of dhrystone iterations
 void __wrap_scanf(const char* fmt, int* n)
 {
-  *n = 100000000;
+  *n = DHRY_RUNS;
+}
+
+static uint64_t begin_cycles, begin_instret;
+static uint64_t cycles, instret;
+
+void dhry_begin(void)
+{
+  begin_instret = bench_instret();
+  begin_cycles = bench_cycles();
+}
+
+void dhry_end(void)
+{
+  cycles = bench_cycles() - begin_cycles;
+  instret = bench_instret() - begin_instret;
+}
+
+/* Scales the runs of the last measurement to DHRY_SECONDS */
+int dhry_calibrate(int runs)
+{
+  uint64_t target = (uint64_t)DHRY_SECONDS * get_cpu_freq();
+  uint64_t n = cycles ? target * runs / cycles : runs;
+
+  if (n < (uint64_t)runs) {
+    n = runs;
+  }
+  return n > INT32_MAX ? INT32_MAX : (int)n;
+}
+
+void dhry_report(int runs)
+{
+  unsigned long freq = get_cpu_freq();
+  /* all in thousandths */
+  uint64_t per_run = cycles * 1000 / runs;
+  uint64_t dmips_per_mhz = cycles ?
+    (uint64_t)runs * 1000000000ull / (cycles * VAX_DHRYSTONES) : 0;
+  uint64_t cpi = instret ? cycles * 1000 / instret : 0;
+  uint64_t per_second = cycles ? (uint64_t)runs * freq / cycles : 0;
+
+  bsp_printf("Cycles for one run through Dhrystone:       %llu.%03u\n",
+             (unsigned long long)(per_run / 1000), (unsigned)(per_run % 1000));
+  bsp_printf("Dhrystones per Second:                      %llu\n",
+             (unsigned long long)per_second);
+  bsp_printf("DMIPS/MHz:                                  %llu.%03u\n",
+             (unsigned long long)(dmips_per_mhz / 1000),
+             (unsigned)(dmips_per_mhz % 1000));
+  bsp_printf("CPI:                                        %llu.%03u\n",
+             (unsigned long long)(cpi / 1000), (unsigned)(cpi % 1000));
+  bsp_printf("\n");
+
+  bench_record_begin("dhrystone");
+  bench_record_u64("runs", runs);
+  bench_record_u64("cycles", cycles);
+  bench_record_u64("instret", instret);
+  bench_record_u64("cpu_freq", freq);
+  bench_record_fixed("cycles_per_run", per_run, 3);
+  bench_record_fixed("dmips_per_mhz", dmips_per_mhz, 3);
+  bench_record_fixed("cpi", cpi, 3);
+  bench_record_end();
+  bench_end();
 }
@@ -7,6 +7,7 @@
 #include "plic/plic_driver.h"
 #include "encoding.h"
 #include <unistd.h>
+#include "sifive/trace.h"
 
 #ifndef _SIFIVE_COREPLEXIP_ARTY_H
 #error 'global_interrupts' demo only supported for Coreplex IP Eval Kits
@@ -48,14 +49,14 @@ void set_timer() {
 void mti_isr(){
  
   if (g_switch1Wins) {
-    printf("#### Giving Switch 1 Priority for 10 seconds ####\n");
+    TRACE("#### Giving Switch 1 Priority for 10 seconds ####\n");
     // All other things being equal, lower IDs have
     // higher priority. We have already set
     // Switch 1 to priority 2
     // in the setup, so by giving these equal priority Switch 1 will win.
     PLIC_set_priority(&g_plic, INT_EXT_DEVICE_SW_2, 2);
   } else {
-    printf("**** Giving Switch 2 Priority for 10 seconds ****\n");
+    TRACE("**** Giving Switch 2 Priority for 10 seconds ****\n");
     // By setting Switch 2 a higher integer priority, it will win over switch 1.
     PLIC_set_priority(&g_plic, INT_EXT_DEVICE_SW_2, 3);
   }    
@@ -95,16 +96,16 @@ void print_instructions() {
 }
 
 void invalid_global_isr() {
-  printf("Unexpected global interrupt!\n");
+  TRACE("Unexpected global interrupt!\n");
 }
 
 void invalid_local_isr() {
-  printf ("Unexpected local interrupt!\n");
+  TRACE("Unexpected local interrupt!\n");
 }
 
 void switch_1_handler() {
 
-  printf("Switch 1 is on! Even if Switch 2 is on, Switch 1 must have higher priority right now.\n");
+  TRACE("Switch 1 is on! Even if Switch 2 is on, Switch 1 must have higher priority right now.\n");
   
   // Set Green LED
   GPIO_REG(GPIO_OUTPUT_VAL)  |=  (0x1 << GREEN_LED_OFFSET) ;
@@ -115,7 +116,7 @@ void switch_1_handler() {
 }
 
 void switch_2_handler() {
-  printf("Switch 2 is on! Even if Switch 1 is on, Switch 2 must have higher priority right now.\n");
+  TRACE("Switch 2 is on! Even if Switch 1 is on, Switch 2 must have higher priority right now.\n");
 
   // Set RED LED
   GPIO_REG(GPIO_OUTPUT_VAL)  &=  ~(0x1 << GREEN_LED_OFFSET) ;
@@ -131,7 +132,7 @@ void pwm_0_handler() {
 
 
   if (g_debounce == 0) {
-    printf("    Done debouncing.\n");
+    TRACE("    Done debouncing.\n");
     
     //Lower the threshold s.t. the switches can hit.
     PLIC_set_threshold(&g_plic, 1);
@@ -151,7 +152,7 @@ void pwm_0_handler() {
 
 void debounce(int local_interrupt_num) {
 
-  printf("    Starting a debounce.\n");
+  TRACE("    Starting a debounce.\n");
 
   g_debounce = 600;
   
@@ -241,8 +242,10 @@ int main(int argc, char **argv)
   // Enable all interrupts
   set_csr(mstatus, MSTATUS_MIE);
   
+  // The handlers only log with TRACE(), print it here.
   while(1){
     asm volatile ("wfi");
+    trace_drain();
   }
   
   return 0;
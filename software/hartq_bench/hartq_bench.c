@@ -0,0 +1,127 @@
+// See LICENSE for license details.
+
+// Throughput and latency of the hartq rings between hart 0 and hart 1.
+//
+//  stream  hart 0 sends MESSAGES words as fast as the ring takes them,
+//          hart 1 sums them up and sends the sum back. Prints cycles
+//          per message and how often the doorbell had to be rung.
+//  ping    hart 0 sends one word and waits for hart 1 to echo it,
+//          PINGS times. Prints the round trip with both harts asleep
+//          in hartq_sleep() between messages and with both spinning.
+
+#include <stdio.h>
+#include <stdint.h>
+#include "encoding.h"
+#include "sifive/smp.h"
+#include "sifive/hartq.h"
+
+#define MESSAGES 10000
+#define PINGS 1000
+
+static hartq_t to1 = HARTQ_INIT(1);
+static hartq_t to0 = HARTQ_INIT(0);
+
+static hartq_t *const from0[] = { &to1 };
+static hartq_t *const from1[] = { &to0 };
+
+static uintptr_t get(hartq_t *q, hartq_t *const *qs, int sleep)
+{
+  uintptr_t msg;
+
+  while (!hartq_recv(q, &msg)) {
+    if (sleep) {
+      hartq_sleep(qs, 1);
+    }
+  }
+  return msg;
+}
+
+static void put(hartq_t *q, uintptr_t msg)
+{
+  while (!hartq_send(q, msg))
+    ;
+}
+
+static void stream(int hartid)
+{
+  if (hartid == 0) {
+    uint32_t rings = to1.rings;
+    uint32_t start = read_csr(mcycle);
+    uintptr_t sum;
+
+    for (uintptr_t i = 1; i <= MESSAGES; i++) {
+      put(&to1, i);
+    }
+    sum = get(&to0, from1, 1);
+    printf("stream  %6u cycles/message, %u doorbells for %u messages%s\n",
+           (unsigned)((read_csr(mcycle) - start) / MESSAGES),
+           (unsigned)(to1.rings - rings), MESSAGES,
+           sum == (uintptr_t)MESSAGES * (MESSAGES + 1) / 2 ? "" : "  BAD SUM");
+  } else {
+    uintptr_t sum = 0;
+
+    for (int i = 0; i < MESSAGES; i++) {
+      sum += get(&to1, from0, 1);
+    }
+    put(&to0, sum);
+  }
+}
+
+static void ping(int hartid, int sleep)
+{
+  if (hartid == 0) {
+    uint32_t start = read_csr(mcycle);
+    int bad = 0;
+
+    for (uintptr_t i = 0; i < PINGS; i++) {
+      put(&to1, i);
+      bad |= get(&to0, from1, sleep) != i;
+    }
+    printf("ping    %6u cycles/round trip (%s)%s\n",
+           (unsigned)((read_csr(mcycle) - start) / PINGS),
+           sleep ? "wfi" : "spin", bad ? "  BAD ECHO" : "");
+  } else {
+    for (int i = 0; i < PINGS; i++) {
+      put(&to0, get(&to1, from0, sleep));
+    }
+  }
+}
+
+static void bench(int hartid)
+{
+  if (smp_harts() < 2) {
+    if (hartid == 0) {
+      printf("hartq_bench needs at least 2 harts, found %d\n", smp_harts());
+    }
+    return;
+  }
+  if (hartid == 0) {
+    printf("%d-word rings, hart 0 -> hart 1\n", HARTQ_SIZE);
+  }
+  if (hartid < 2) {
+    stream(hartid);
+  }
+  smp_barrier();
+  if (hartid < 2) {
+    ping(hartid, 1);
+  }
+  smp_barrier();
+  if (hartid < 2) {
+    ping(hartid, 0);
+  }
+  smp_barrier();
+}
+
+int secondary_main(int hartid)
+{
+  bench(hartid);
+  while (1) {
+    __asm__ __volatile__ ("wfi");
+  }
+}
+
+int main()
+{
+  bench(0);
+  return 0;
+}
@@ -10,6 +10,95 @@
 /* Local includes */
 #include "UART_driver.h"
 
+/* Receive ring, filled from the RX FIFO by UART_rx_isr() or, while the
+ * interrupt is off, by UART_probe_rx(). head and tail run freely and are
+ * masked on access, so head - tail is the fill level.
+ */
+static char rxbuf[UART_RXBUF_SIZE];
+static volatile uint32_t rxbuf_head;
+static volatile uint32_t rxbuf_tail;
+/* bytes lost because the ring was full */
+static volatile uint32_t rxbuf_dropped;
+static volatile int rx_irq_enabled;
+
+/* Moves everything from the RX FIFO into the ring.
+ *
+ * Returns the number of bytes taken from the FIFO.
+ */
+static int rx_drain(void)
+{
+  int32_t c;
+  int n = 0;
+
+  while ((c = UART0_REG(UART_REG_RXFIFO)) >= 0) {
+    if (rxbuf_head - rxbuf_tail == UART_RXBUF_SIZE) {
+      rxbuf_dropped++;
+    } else {
+      rxbuf[rxbuf_head & UART_RXBUF_MASK] = (char)c;
+      /* the byte has to be in the ring before the reader can see it */
+      asm volatile ("" ::: "memory");
+      rxbuf_head++;
+    }
+    n++;
+  }
+  return n;
+}
+
+/* Sleeps until the next interrupt if the ring is empty. Interrupts are
+ * masked around the check so a byte arriving in between still wakes
+ * the wfi up.
+ *
+ * Called with interrupts masked, UART_rx_isr() cannot run and the wfi
+ * would only return to an empty ring again. The FIFO is drained here
+ * instead, as UART_probe_rx() does in polled mode.
+ */
+static void rx_wait(void)
+{
+  unsigned long mstatus = clear_csr(mstatus, MSTATUS_MIE);
+
+  if (!(mstatus & MSTATUS_MIE)) {
+    rx_drain();
+    return;
+  }
+  if (rxbuf_head == rxbuf_tail) {
+    asm volatile ("wfi");
+  }
+  set_csr(mstatus, MSTATUS_MIE);
+}
+
+/* Switches between interrupt driven and polled receive. The caller has
+ * to route INT_UART0_BASE to UART_rx_isr() in the PLIC.
+ *
+ * enable: non-zero to raise an interrupt for every received byte.
+ */
+void UART_rx_irq(int enable)
+{
+  if (enable) {
+    /* RXWM fires while the FIFO holds more than 0 bytes */
+    UART0_REG(UART_REG_RXCTRL) = UART_RXWM(0) | UART_RXEN;
+    rx_irq_enabled = 1;
+    UART0_REG(UART_REG_IE) |= UART_IP_RXWM;
+  } else {
+    UART0_REG(UART_REG_IE) &= ~UART_IP_RXWM;
+    rx_irq_enabled = 0;
+  }
+}
+
+/* PLIC handler for INT_UART0_BASE
+ */
+void UART_rx_isr(void)
+{
+  rx_drain();
+}
+
+/* Returns the number of received bytes dropped because the ring was
+ * full.
+ */
+uint32_t UART_rx_dropped(void)
+{
+  return rxbuf_dropped;
+}
+
 /* Enables the UART for I/O.
  *
  * baud: baud rate to set.
@@ -81,10 +170,9 @@ void UART_set_stop_bits(int stop_bits)
 int UART_put_char(char ch, int blocking)
 {
   volatile uint32_t *val = &UART0_REG(UART_REG_TXFIFO);
-  uint32_t busy = (*val) & 0x80000000;
   if (blocking) {
     while (*val & 0x80000000);
-  } else if (busy){
+  } else if (*val & 0x80000000) {
     return -1;
   }
   UART0_REG(UART_REG_TXFIFO) = ch;
@@ -92,6 +180,8 @@ int UART_put_char(char ch, int blocking)
 }
 
 /* Retrieves a single character from the UART receive buffer.
+ * Blocking waits with wfi when the receive interrupt is enabled and
+ * polls the FIFO otherwise.
  *
  * ch: pointer to a destination char to put the read character into.
  * blocking: whether the function should block until success.
@@ -100,37 +190,38 @@ int UART_put_char(char ch, int blocking)
  */
 int UART_get_char(char * ch, int blocking)
 {
-  int busy;
-
-  do {
-    UART_probe_rx();
-    busy = (rxbuf_head == rxbuf_tail);
-  } while (blocking && busy);
-
-  if (busy) {
-    return -1;
+  while (rxbuf_head == rxbuf_tail) {
+    if (!rx_irq_enabled) {
+      UART_probe_rx();
+      if (rxbuf_head != rxbuf_tail) {
+        break;
+      }
+    }
+    if (!blocking) {
+      return -1;
+    }
+    if (rx_irq_enabled) {
+      rx_wait();
+    }
   }
 
-  *ch = rxbuf[rxbuf_tail++];
-  rxbuf_tail &= UART_RXBUF_MASK;
+  *ch = rxbuf[rxbuf_tail & UART_RXBUF_MASK];
+  rxbuf_tail++;
   return 0;
 }
 
-/* Checks whether a byte is pending in UART receive buffer and
- * pops it if present.
+/* Moves pending bytes from the UART receive FIFO into the receive
+ * buffer. Does nothing while the receive interrupt is enabled, the
+ * interrupt handler owns the FIFO then.
  *
- * Returns 0 on success.
+ * Returns 0 if bytes were moved.
  */
 int UART_probe_rx()
 {
-  int32_t c;
-
-  if ((c = UART0_REG(UART_REG_RXFIFO)) >= 0) {
-    rxbuf[rxbuf_head++] = (char)c;
-    rxbuf_head &= UART_RXBUF_MASK;
-    return 0;
+  if (rx_irq_enabled) {
+    return -1;
   }
-  return -1;
+  return rx_drain() ? 0 : -1;
 }
 
 /* Writes a string to the UART.
@@ -142,16 +233,54 @@ int UART_probe_rx()
  */
 int UART_write(char * msg, int blocking)
 {
-  int i, ret;
-  for (i=0; i<strlen(msg); i++) {
-    ret = UART_put_char(msg[i], blocking);
-    if (0 != ret) {
+  return UART_write_n(msg, strlen(msg), blocking);
+}
+
+/* Writes len bytes to the UART, msg does not need to be terminated.
+ * Shares the burst writer with write() on stdout.
+ *
+ * msg: the bytes to ouput.
+ * len: number of bytes in msg.
+ * blocking: enable to enforce waiting
+ *
+ * Returns the number of bytes written.
+ */
+int UART_write_n(const char * msg, int len, int blocking)
+{
+  return (int)uart_write(msg, len, 0, blocking);
+}
+
+/* Reads whatever is in the receive buffer, up to max_chars bytes.
+ *
+ * buffer: pointer to a char array to write characters into.
+ * max_chars: maximum number of characters to read.
+ * blocking: wait until at least one byte is available.
+ *
+ * Returns the number of bytes read.
+ */
+int UART_read(char * buffer, int max_chars, int blocking)
+{
+  int i = 0;
+
+  if (max_chars > 0 && 0 == UART_get_char(&buffer[i], blocking)) {
+    for (i = 1; i < max_chars; i++) {
+      if (0 != UART_get_char(&buffer[i], 0)) {
         break;
+      }
     }
   }
   return i;
 }
 
+/* Receive hook of __wrap_read() in libwrap, so read() on stdin goes
+ * through the receive buffer instead of racing the interrupt handler for
+ * the FIFO.
+ */
+ssize_t __uart_read(void *ptr, size_t len)
+{
+  return UART_read((char *)ptr, (int)len, 0);
+}
+
 /* Reads a string from the UART device and places the result
  * into a buffer. Reading stops when either the end of the string is
  * reached, the specified buffer size is reached or a terminating
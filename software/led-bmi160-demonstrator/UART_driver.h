@@ -9,21 +9,31 @@
 /* HiFive/FE310 includes*/
 #include "platform.h"
 
+/* Size of the receive ring as a power of two, the hardware FIFO only
+ * holds 8 bytes which is less than a millisecond at 115200 baud.
+ */
+#ifndef UART_RXBUF_ORDER
+#define UART_RXBUF_ORDER 8
+#endif
+
 enum {
-  UART_RXBUF_SIZE = (1 << 3),
+  UART_RXBUF_SIZE = (1 << UART_RXBUF_ORDER),
   UART_RXBUF_MASK = (UART_RXBUF_SIZE - 1)
 };
 
-volatile uint8_t rxbuf_head;
-volatile uint8_t rxbuf_tail;
-char rxbuf[UART_RXBUF_SIZE];
-
 /* Top-level functions */
 void UART_init(unsigned long baud, int stop_bits);
 void UART_deinit();
 int UART_write(char * msg, int blocking);
+int UART_write_n(const char * msg, int len, int blocking);
+int UART_read(char * buffer, int max_chars, int blocking);
 int UART_read_n(char * buffer, int max_chars, char terminator, int blocking);
 
+/* Interrupt driven receive */
+void UART_rx_irq(int enable);
+void UART_rx_isr(void);
+uint32_t UART_rx_dropped(void);
+
 /* Worker functions */
 int UART_probe_rx();
 int UART_get_char(char * ch, int blocking);
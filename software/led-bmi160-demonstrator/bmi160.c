@@ -1348,6 +1348,64 @@ static int8_t map_hardware_interrupt(const struct bmi160_int_settg *int_config,
  *  @retval zero -> Success  / -ve value -> Error
  */
 static int8_t map_feature_interrupt(const struct bmi160_int_settg *int_config, const struct bmi160_dev *dev);
+
+/*!
+ *  @brief This API returns the bits of the register cache window covered
+ *  by reg_addr..reg_addr+len-1, or zero if the range is not fully inside it.
+ *
+ *  @param[in] reg_addr : Register address.
+ *  @param[in] len      : Number of registers.
+ *
+ *  @return Bit mask of cache entries
+ */
+static uint64_t cache_range_mask(uint8_t reg_addr, uint16_t len);
+
+/*!
+ *  @brief This API returns a mask with all bits set between the lowest
+ *  and the highest set bit of bits.
+ *
+ *  @param[in] bits : Non-zero bit mask.
+ *
+ *  @return Contiguous bit mask
+ */
+static uint64_t fill_span(uint64_t bits);
+
+/*!
+ *  @brief This API writes all batched registers to the sensor in one
+ *  burst transfer.
+ *
+ *  @param[in] dev : Structure instance of bmi160_dev.
+ *
+ *  @return Result of API execution status
+ *  @retval zero -> Success  / -ve value -> Error
+ */
+static int8_t flush_batch(const struct bmi160_dev *dev);
+
+/*!
+ *  @brief This API reads registers over the bus, bypassing the cache.
+ *
+ *  @param[in] reg_addr : Register address.
+ *  @param[out] data    : Pointer to data buffer to store the read data.
+ *  @param[in] len      : No of bytes of data to be read.
+ *  @param[in] dev      : Structure instance of bmi160_dev.
+ *
+ *  @return Result of API execution status
+ *  @retval zero -> Success  / -ve value -> Error
+ */
+static int8_t read_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const struct bmi160_dev *dev);
+
+/*!
+ *  @brief This API writes registers over the bus, bypassing the cache.
+ *
+ *  @param[in] reg_addr : Register address.
+ *  @param[in] data     : Pointer to data buffer holding the data to write.
+ *  @param[in] len      : No of bytes of data to be written.
+ *  @param[in] dev      : Structure instance of bmi160_dev.
+ *
+ *  @return Result of API execution status
+ *  @retval zero -> Success  / -ve value -> Error
+ */
+static int8_t write_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const struct bmi160_dev *dev);
 /*********************** User function definitions ****************************/
 /*!
  * @brief This API reads the data from the given register address
@@ -1356,19 +1414,26 @@ static int8_t map_feature_interrupt(const struct bmi160_int_settg *int_config, c
 int8_t bmi160_get_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const struct bmi160_dev *dev)
 {
     int8_t rslt = BMI160_OK;
+    uint64_t mask;
+
     /* Null-pointer check */
     if ((dev == NULL) || (dev->read == NULL)) {
         rslt = BMI160_E_NULL_PTR;
     } else {
-        /* Configuring reg_addr for SPI Interface */
-        if (dev->interface == BMI160_SPI_INTF)
-            reg_addr = (reg_addr | BMI160_SPI_RD_MASK);
-
-        rslt = dev->read(dev->id, reg_addr, data, len);
-        /* Kindly refer section 3.2.4 of data-sheet*/
-        dev->delay_ms(1);
-        if (rslt != BMI160_OK)
-            rslt = BMI160_E_COM_FAIL;
+        mask = (dev->cache != NULL) ? cache_range_mask(reg_addr, len) : 0;
+        if ((mask != 0) && ((dev->cache->valid & mask) == mask)) {
+            /* Served from the register shadow */
+            memcpy(data, &dev->cache->regs[reg_addr - BMI160_CACHE_START_ADDR], len);
+        } else {
+            /* Batched writes have to reach the sensor before it is read */
+            rslt = flush_batch(dev);
+            if (rslt == BMI160_OK)
+                rslt = read_regs(reg_addr, data, len, dev);
+            if ((rslt == BMI160_OK) && (mask != 0)) {
+                memcpy(&dev->cache->regs[reg_addr - BMI160_CACHE_START_ADDR], data, len);
+                dev->cache->valid |= mask & ~BMI160_CACHE_VOLATILE_MASK;
+            }
+        }
     }
 
     return rslt;
@@ -1381,39 +1446,127 @@ int8_t bmi160_get_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const stru
 int8_t bmi160_set_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const struct bmi160_dev *dev)
 {
     int8_t rslt = BMI160_OK;
-    uint8_t count = 0;
+    uint64_t mask;
+    uint64_t span;
+    struct bmi160_reg_cache *cache;
+
     /* Null-pointer check */
-    if ((dev == NULL) || (dev->write == NULL)) {
-        rslt = BMI160_E_NULL_PTR;
-    } else {
-        /* Configuring reg_addr for SPI Interface */
-        if (dev->interface == BMI160_SPI_INTF)
-            reg_addr = (reg_addr & BMI160_SPI_WR_MASK);
+    if ((dev == NULL) || (dev->write == NULL))
+        return BMI160_E_NULL_PTR;
+
+    cache = dev->cache;
+    mask = (cache != NULL) ? cache_range_mask(reg_addr, len) : 0;
+
+    if ((mask != 0) && (cache->batch_depth != 0) && ((mask & BMI160_CACHE_VOLATILE_MASK) == 0)) {
+        if (cache->dirty != 0) {
+            /* Registers between the pending writes and this one are
+             * rewritten from the shadow, so they have to be known */
+            span = fill_span(cache->dirty | mask);
+            if ((span & ~(cache->valid | mask)) || (span & BMI160_CACHE_VOLATILE_MASK))
+                rslt = flush_batch(dev);
+        }
+        if (rslt == BMI160_OK) {
+            memcpy(&cache->regs[reg_addr - BMI160_CACHE_START_ADDR], data, len);
+            cache->valid |= mask;
+            cache->dirty |= mask;
+        }
+
+        return rslt;
+    }
 
-        if ((dev->prev_accel_cfg.power == BMI160_ACCEL_NORMAL_MODE) ||
-            (dev->prev_gyro_cfg.power == BMI160_GYRO_NORMAL_MODE)) {
+    /* Keep the order of batched and direct writes */
+    rslt = flush_batch(dev);
+    if (rslt == BMI160_OK)
+        rslt = write_regs(reg_addr, data, len, dev);
 
-            rslt = dev->write(dev->id, reg_addr, data, len);
-            /* Kindly refer section 3.2.4 of data-sheet*/
-            dev->delay_ms(1);
+    if (mask != 0) {
+        if (rslt == BMI160_OK) {
+            memcpy(&cache->regs[reg_addr - BMI160_CACHE_START_ADDR], data, len);
+            cache->valid |= mask & ~BMI160_CACHE_VOLATILE_MASK;
         } else {
-            /*Burst write is not allowed in
-            suspend & low power mode */
-            for (; count < len; count++) {
-                rslt = dev->write(dev->id, reg_addr, &data[count], 1);
-                reg_addr++;
-                /* Kindly refer section 3.2.4 of data-sheet*/
-                dev->delay_ms(1);
-            }
+            cache->valid &= ~mask;
         }
+    }
 
-        if (rslt != BMI160_OK)
-            rslt = BMI160_E_COM_FAIL;
+    if ((cache != NULL) && (reg_addr <= BMI160_COMMAND_REG_ADDR)
+        && ((reg_addr + len) > BMI160_COMMAND_REG_ADDR)) {
+        /* Soft reset and FOC change registers behind our back */
+        uint8_t cmd = data[BMI160_COMMAND_REG_ADDR - reg_addr];
+
+        if ((cmd == BMI160_SOFT_RESET_CMD) || (cmd == BMI160_START_FOC_CMD))
+            bmi160_cache_invalidate(dev);
+    }
+
+    return rslt;
+}
+
+/*!
+ * @brief This API starts coalescing register writes.
+ */
+int8_t bmi160_batch_begin(const struct bmi160_dev *dev)
+{
+    int8_t rslt = BMI160_OK;
+
+    if (dev == NULL)
+        rslt = BMI160_E_NULL_PTR;
+    else if (dev->cache != NULL)
+        dev->cache->batch_depth++;
+
+    return rslt;
+}
+
+/*!
+ * @brief This API ends a batch and writes the coalesced registers.
+ */
+int8_t bmi160_batch_commit(const struct bmi160_dev *dev)
+{
+    int8_t rslt = BMI160_OK;
+
+    if (dev == NULL) {
+        rslt = BMI160_E_NULL_PTR;
+    } else if ((dev->cache != NULL) && (dev->cache->batch_depth != 0)) {
+        dev->cache->batch_depth--;
+        if (dev->cache->batch_depth == 0)
+            rslt = flush_batch(dev);
+    }
+
+    return rslt;
+}
+
+/*!
+ * @brief This API fills the register shadow with one burst read.
+ */
+int8_t bmi160_cache_sync(const struct bmi160_dev *dev)
+{
+    int8_t rslt;
+
+    if ((dev == NULL) || (dev->read == NULL) || (dev->cache == NULL)) {
+        rslt = BMI160_E_NULL_PTR;
+    } else {
+        rslt = flush_batch(dev);
+        if (rslt == BMI160_OK) {
+            dev->cache->valid = 0;
+            rslt = read_regs(BMI160_CACHE_START_ADDR, dev->cache->regs, BMI160_CACHE_LEN, dev);
+            if (rslt == BMI160_OK)
+                dev->cache->valid = cache_range_mask(BMI160_CACHE_START_ADDR, BMI160_CACHE_LEN)
+                            & ~BMI160_CACHE_VOLATILE_MASK;
+        }
     }
 
     return rslt;
 }
 
+/*!
+ * @brief This API drops all cached register values.
+ */
+void bmi160_cache_invalidate(const struct bmi160_dev *dev)
+{
+    if ((dev != NULL) && (dev->cache != NULL)) {
+        dev->cache->valid = 0;
+        dev->cache->dirty = 0;
+    }
+}
+
 /*!
  *  @brief This API is the entry point for sensor.It performs
  *  the selection of I2C/SPI read mechanism according to the
@@ -1478,6 +1631,9 @@ int8_t bmi160_soft_reset(struct bmi160_dev *dev)
         if (rslt == BMI160_OK) {
             /* Update the default parameters */
             default_param_settg(dev);
+            /* Prime the register shadow with the reset values */
+            if (dev->cache != NULL)
+                rslt = bmi160_cache_sync(dev);
         }
     }
 
@@ -1496,15 +1652,18 @@ int8_t bmi160_set_sens_conf(struct bmi160_dev *dev)
     if ((dev == NULL) || (dev->delay_ms == NULL)) {
         rslt = BMI160_E_NULL_PTR;
     } else {
+        /* ACC_CONF..GYR_RANGE are adjacent, send them as one burst */
+        bmi160_batch_begin(dev);
         rslt = set_accel_conf(dev);
-        if (rslt == BMI160_OK) {
+        if (rslt == BMI160_OK)
             rslt = set_gyro_conf(dev);
-            if (rslt == BMI160_OK) {
-                /* write power mode for accel and gyro */
-                rslt = bmi160_set_power_mode(dev);
-                if (rslt == BMI160_OK)
-                    rslt = check_invalid_settg(dev);
-            }
+        if (bmi160_batch_commit(dev) != BMI160_OK)
+            rslt = BMI160_E_COM_FAIL;
+        if (rslt == BMI160_OK) {
+            /* write power mode for accel and gyro */
+            rslt = bmi160_set_power_mode(dev);
+            if (rslt == BMI160_OK)
+                rslt = check_invalid_settg(dev);
         }
     }
 
@@ -1616,6 +1775,9 @@ int8_t bmi160_set_int_config(struct bmi160_int_settg *int_config, struct bmi160_
 {
     int8_t rslt = BMI160_OK;
 
+    /* The interrupt registers are mostly adjacent, coalesce the writes */
+    bmi160_batch_begin(dev);
+
     switch (int_config->int_type) {
     case BMI160_ACC_ANY_MOTION_INT:
         /*Any-motion  interrupt*/
@@ -1674,6 +1836,10 @@ int8_t bmi160_set_int_config(struct bmi160_int_settg *int_config, struct bmi160_
     default:
         break;
     }
+
+    if ((bmi160_batch_commit(dev) != BMI160_OK) && (rslt == BMI160_OK))
+        rslt = BMI160_E_COM_FAIL;
+
     return rslt;
 }
 
@@ -2237,6 +2403,134 @@ int8_t bmi160_extract_aux(struct bmi160_aux_data *aux_data, uint8_t *aux_len, st
     return rslt;
 }
 
+/*!
+ *  @brief This API prepares a single-pass iterator over the FIFO data
+ *  read by the "bmi160_get_fifo_data" API.
+ */
+int8_t bmi160_fifo_iter_init(struct bmi160_fifo_iter *iter, struct bmi160_dev const *dev)
+{
+    int8_t rslt = BMI160_OK;
+
+    if ((iter == NULL) || (dev == NULL) || (dev->fifo == NULL) || (dev->fifo->data == NULL)) {
+        rslt = BMI160_E_NULL_PTR;
+    } else {
+        iter->data = dev->fifo->data;
+        iter->length = dev->fifo->length;
+        iter->idx = 0;
+        iter->header_enable = dev->fifo->fifo_header_enable;
+        iter->data_enable = dev->fifo->fifo_data_enable;
+    }
+
+    return rslt;
+}
+
+/*!
+ *  @brief This API decodes the next frame of the FIFO data.
+ */
+int8_t bmi160_fifo_next(struct bmi160_fifo_iter *iter, struct bmi160_fifo_view *view)
+{
+    const uint8_t *frame;
+    uint8_t content;
+    uint8_t frame_len;
+
+    if ((iter == NULL) || (view == NULL))
+        return BMI160_E_NULL_PTR;
+
+    if (iter->idx >= iter->length)
+        return BMI160_W_FIFO_EMPTY;
+
+    frame = &iter->data[iter->idx];
+    view->mag = NULL;
+    view->gyro = NULL;
+    view->accel = NULL;
+
+    if (iter->header_enable == 0) {
+        /* Header-less mode: every frame has the layout of fifo_data_enable */
+        content = iter->data_enable;
+        if (((iter->idx + 2) <= iter->length) && (frame[0] == FIFO_CONFIG_MSB_CHECK)
+            && (frame[1] == FIFO_CONFIG_LSB_CHECK)) {
+            /* FIFO was empty, the rest of the buffer is over read */
+            content = 0;
+        }
+    } else {
+        uint8_t frame_header = frame[0] & BMI160_FIFO_TAG_INTR_MASK;
+
+        frame++;
+        iter->idx++;
+        switch (frame_header) {
+        case BMI160_FIFO_HEAD_SENSOR_TIME:
+            if ((iter->idx + BMI160_SENSOR_TIME_LENGTH) > iter->length)
+                break;
+            view->kind = BMI160_FIFO_FRAME_SENSORTIME;
+            view->sensor_time = ((uint32_t)frame[BMI160_SENSOR_TIME_MSB_BYTE] << 16)
+                | ((uint32_t)frame[BMI160_SENSOR_TIME_XLSB_BYTE] << 8) | frame[0];
+            iter->idx += BMI160_SENSOR_TIME_LENGTH;
+            return BMI160_OK;
+        case BMI160_FIFO_HEAD_SKIP_FRAME:
+        case BMI160_FIFO_HEAD_INPUT_CONFIG:
+            if (iter->idx >= iter->length)
+                break;
+            if (frame_header == BMI160_FIFO_HEAD_SKIP_FRAME) {
+                view->kind = BMI160_FIFO_FRAME_SKIP;
+                view->skipped_frame_count = frame[0];
+            } else {
+                view->kind = BMI160_FIFO_FRAME_CONFIG;
+            }
+            iter->idx++;
+            return BMI160_OK;
+        default:
+            break;
+        }
+
+        /* Data frame headers carry the m/g/a flags in bits 4..2 */
+        content = 0;
+        if ((frame_header & 0xE0) == 0x80) {
+            if (frame_header & 0x10)
+                content |= BMI160_FIFO_M_ENABLE;
+            if (frame_header & 0x08)
+                content |= BMI160_FIFO_G_ENABLE;
+            if (frame_header & 0x04)
+                content |= BMI160_FIFO_A_ENABLE;
+        }
+    }
+
+    frame_len = 0;
+    if (content & BMI160_FIFO_M_ENABLE) {
+        view->mag = frame;
+        frame_len += BMI160_FIFO_M_LENGTH;
+    }
+    if (content & BMI160_FIFO_G_ENABLE) {
+        view->gyro = frame + frame_len;
+        frame_len += BMI160_FIFO_G_LENGTH;
+    }
+    if (content & BMI160_FIFO_A_ENABLE) {
+        view->accel = frame + frame_len;
+        frame_len += BMI160_FIFO_A_LENGTH;
+    }
+
+    if ((frame_len == 0) || ((iter->idx + frame_len) > iter->length)) {
+        /* Over read, unknown header or partial frame: stop parsing */
+        iter->idx = iter->length;
+        return BMI160_W_FIFO_EMPTY;
+    }
+
+    view->kind = BMI160_FIFO_FRAME_DATA;
+    iter->idx += frame_len;
+
+    return BMI160_OK;
+}
+
+/*!
+ *  @brief This API converts a raw 6 byte gyro/accel payload into the
+ *  x,y,z fields of bmi160_sensor_data.
+ */
+void bmi160_fifo_unpack_xyz(const uint8_t *raw, struct bmi160_sensor_data *data)
+{
+    data->x = (int16_t)(((uint16_t)raw[1] << 8) | raw[0]);
+    data->y = (int16_t)(((uint16_t)raw[3] << 8) | raw[2]);
+    data->z = (int16_t)(((uint16_t)raw[5] << 8) | raw[4]);
+}
+
 /*!
  *  @brief This API starts the FOC of accel and gyro
  *
@@ -5693,4 +5987,125 @@ static int8_t trigger_foc(struct bmi160_offsets *offset, struct bmi160_dev const
     return rslt;
 }
 
+/*!
+ *  @brief This API returns the bits of the register cache window covered
+ *  by reg_addr..reg_addr+len-1, or zero if the range is not fully inside it.
+ */
+static uint64_t cache_range_mask(uint8_t reg_addr, uint16_t len)
+{
+    if ((len == 0) || (reg_addr < BMI160_CACHE_START_ADDR)
+        || ((reg_addr + len - 1) > BMI160_CACHE_END_ADDR))
+        return 0;
+
+    return ((UINT64_C(1) << len) - 1) << (reg_addr - BMI160_CACHE_START_ADDR);
+}
+
+/*!
+ *  @brief This API returns a mask with all bits set between the lowest
+ *  and the highest set bit of bits.
+ */
+static uint64_t fill_span(uint64_t bits)
+{
+    uint64_t low = bits & (~bits + 1);
+    uint64_t high = bits;
+
+    /* Smear the highest set bit downwards */
+    high |= high >> 1;
+    high |= high >> 2;
+    high |= high >> 4;
+    high |= high >> 8;
+    high |= high >> 16;
+    high |= high >> 32;
+
+    return high & ~(low - 1);
+}
+
+/*!
+ *  @brief This API writes all batched registers to the sensor in one
+ *  burst transfer.
+ */
+static int8_t flush_batch(const struct bmi160_dev *dev)
+{
+    int8_t rslt = BMI160_OK;
+    struct bmi160_reg_cache *cache = dev->cache;
+    uint64_t span;
+    uint8_t lo = 0;
+    uint8_t len = 0;
+
+    if ((cache != NULL) && (cache->dirty != 0)) {
+        span = fill_span(cache->dirty);
+        cache->dirty = 0;
+        while (!(span & (UINT64_C(1) << lo)))
+            lo++;
+        while (span & (UINT64_C(1) << (lo + len)))
+            len++;
+        rslt = write_regs(BMI160_CACHE_START_ADDR + lo, &cache->regs[lo], len, dev);
+        if (rslt != BMI160_OK)
+            cache->valid &= ~span;
+    }
+
+    return rslt;
+}
+
+/*!
+ *  @brief This API reads registers over the bus, bypassing the cache.
+ */
+static int8_t read_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const struct bmi160_dev *dev)
+{
+    int8_t rslt;
+
+    /* Configuring reg_addr for SPI Interface */
+    if (dev->interface == BMI160_SPI_INTF)
+        reg_addr = (reg_addr | BMI160_SPI_RD_MASK);
+
+    rslt = dev->read(dev->id, reg_addr, data, len);
+    if (dev->cache != NULL)
+        dev->cache->transfers++;
+    /* Kindly refer section 3.2.4 of data-sheet*/
+    dev->delay_ms(1);
+    if (rslt != BMI160_OK)
+        rslt = BMI160_E_COM_FAIL;
+
+    return rslt;
+}
+
+/*!
+ *  @brief This API writes registers over the bus, bypassing the cache.
+ */
+static int8_t write_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const struct bmi160_dev *dev)
+{
+    int8_t rslt = BMI160_OK;
+    uint16_t count = 0;
+
+    /* Configuring reg_addr for SPI Interface */
+    if (dev->interface == BMI160_SPI_INTF)
+        reg_addr = (reg_addr & BMI160_SPI_WR_MASK);
+
+    if ((dev->prev_accel_cfg.power == BMI160_ACCEL_NORMAL_MODE) ||
+        (dev->prev_gyro_cfg.power == BMI160_GYRO_NORMAL_MODE)) {
+
+        rslt = dev->write(dev->id, reg_addr, data, len);
+        if (dev->cache != NULL)
+            dev->cache->transfers++;
+        /* Kindly refer section 3.2.4 of data-sheet*/
+        dev->delay_ms(1);
+    } else {
+        /*Burst write is not allowed in
+        suspend & low power mode */
+        for (; count < len; count++) {
+            rslt = dev->write(dev->id, reg_addr, &data[count], 1);
+            if (dev->cache != NULL)
+                dev->cache->transfers++;
+            reg_addr++;
+            /* Kindly refer section 3.2.4 of data-sheet*/
+            dev->delay_ms(1);
+        }
+    }
+
+    if (rslt != BMI160_OK)
+        rslt = BMI160_E_COM_FAIL;
+
+    return rslt;
+}
+
 /** @}*/
@@ -113,6 +113,49 @@ int8_t bmi160_get_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const stru
  */
 int8_t bmi160_set_regs(uint8_t reg_addr, uint8_t *data, uint16_t len, const struct bmi160_dev *dev);
 
+/*!
+ * @brief This API starts coalescing register writes. Writes to the
+ * cached configuration registers are only stored in dev->cache until
+ * the matching bmi160_batch_commit(), which sends adjacent registers in
+ * one burst. Calls may be nested. Without a cache this is a no-op.
+ *
+ * @param[in] dev       : Structure instance of bmi160_dev.
+ *
+ * @return Result of API execution status
+ * @retval zero -> Success / -ve value -> Error
+ */
+int8_t bmi160_batch_begin(const struct bmi160_dev *dev);
+
+/*!
+ * @brief This API ends a batch started by bmi160_batch_begin() and
+ * writes the coalesced registers to the sensor.
+ *
+ * @param[in] dev       : Structure instance of bmi160_dev.
+ *
+ * @return Result of API execution status
+ * @retval zero -> Success / -ve value -> Error
+ */
+int8_t bmi160_batch_commit(const struct bmi160_dev *dev);
+
+/*!
+ * @brief This API reloads the whole register shadow in dev->cache
+ * with a single burst read. It is called by bmi160_soft_reset().
+ *
+ * @param[in] dev       : Structure instance of bmi160_dev.
+ *
+ * @return Result of API execution status
+ * @retval zero -> Success / -ve value -> Error
+ */
+int8_t bmi160_cache_sync(const struct bmi160_dev *dev);
+
+/*!
+ * @brief This API drops all cached register values and pending
+ * batched writes, e.g. after the sensor was reset externally.
+ *
+ * @param[in] dev       : Structure instance of bmi160_dev.
+ */
+void bmi160_cache_invalidate(const struct bmi160_dev *dev);
+
 /*!
  * @brief This API resets and restarts the device.
  * All register values are overwritten with default parameters.
@@ -568,6 +611,46 @@ int8_t bmi160_extract_gyro(struct bmi160_sensor_data *gyro_data, uint8_t *gyro_l
  */
 int8_t bmi160_extract_aux(struct bmi160_aux_data *aux_data, uint8_t *aux_len, struct bmi160_dev const *dev);
 
+/*!
+ *  @brief This API prepares a single-pass iterator over the FIFO data
+ *  read by the "bmi160_get_fifo_data" API.
+ *
+ *  @note Unlike the bmi160_extract_* APIs the iterator decodes each frame
+ *  header exactly once and hands out pointers into dev->fifo->data instead
+ *  of copying, so accel, gyro and aux can be consumed in one walk.
+ *
+ *  @param[out] iter        : Structure instance of bmi160_fifo_iter.
+ *  @param[in] dev          : Structure instance of bmi160_dev.
+ *
+ *  @return Result of API execution status
+ *  @retval 0 -> Success
+ *  @retval Any non zero value -> Fail
+ */
+int8_t bmi160_fifo_iter_init(struct bmi160_fifo_iter *iter, struct bmi160_dev const *dev);
+
+/*!
+ *  @brief This API decodes the next frame of the FIFO data.
+ *
+ *  @param[in,out] iter     : Structure instance of bmi160_fifo_iter.
+ *  @param[out] view        : Structure instance of bmi160_fifo_view which
+ *                            describes the decoded frame.
+ *
+ *  @return Result of API execution status
+ *  @retval 0 -> A frame was decoded into view
+ *  @retval BMI160_W_FIFO_EMPTY -> No more complete frames
+ *  @retval Any negative value -> Fail
+ */
+int8_t bmi160_fifo_next(struct bmi160_fifo_iter *iter, struct bmi160_fifo_view *view);
+
+/*!
+ *  @brief This API converts a raw 6 byte gyro/accel payload handed out
+ *  by "bmi160_fifo_next" into the x,y,z fields of bmi160_sensor_data.
+ *
+ *  @param[in] raw          : Pointer to the raw payload.
+ *  @param[out] data        : Structure instance of bmi160_sensor_data.
+ */
+void bmi160_fifo_unpack_xyz(const uint8_t *raw, struct bmi160_sensor_data *data);
+
 /*!
  *  @brief This API starts the FOC of accel and gyro
  *
@@ -356,6 +356,17 @@
 /**\name API warning codes */
 #define BMI160_W_GYRO_SELF_TEST_FAIL	INT8_C(1)
 #define BMI160_W_ACCEl_SELF_TEST_FAIL	INT8_C(2)
+#define BMI160_W_FIFO_EMPTY		INT8_C(3)
+
+/** Register shadow cache window (configuration registers) */
+#define BMI160_CACHE_START_ADDR          BMI160_ACCEL_CONFIG_ADDR
+#define BMI160_CACHE_END_ADDR            BMI160_INT_STEP_CONFIG_1_ADDR
+#define BMI160_CACHE_LEN                 (BMI160_CACHE_END_ADDR - BMI160_CACHE_START_ADDR + 1)
+/** Registers inside the window that are updated by the sensor itself */
+#define BMI160_CACHE_VOLATILE_MASK \
+	((UINT64_C(1) << (BMI160_SELF_TEST_ADDR - BMI160_CACHE_START_ADDR)) | \
+	 (UINT64_C(1) << (BMI160_INT_STEP_CNT_0_ADDR - BMI160_CACHE_START_ADDR)) | \
+	 (UINT64_C(1) << (BMI160_INT_STEP_CNT_0_ADDR + 1 - BMI160_CACHE_START_ADDR)))
 
 /** BMI160 unique chip identifier */
 #define BMI160_CHIP_ID                   UINT8_C(0xD1)
@@ -1422,6 +1433,76 @@ struct bmi160_fifo_frame {
 	uint8_t skipped_frame_count;
 };
 
+/*!
+ * @brief Kind of frame returned by the single-pass FIFO iterator
+ */
+enum bmi160_fifo_frame_kind {
+	/*! Sensor data frame, any of mag/gyro/accel may be present */
+	BMI160_FIFO_FRAME_DATA,
+	/*! Sensor time frame */
+	BMI160_FIFO_FRAME_SENSORTIME,
+	/*! Skip frame, carries the number of dropped frames */
+	BMI160_FIFO_FRAME_SKIP,
+	/*! Input config changed frame */
+	BMI160_FIFO_FRAME_CONFIG
+};
+
+/*!
+ * @brief Cursor over the raw FIFO buffer (dev->fifo->data)
+ */
+struct bmi160_fifo_iter {
+	/*! FIFO buffer being walked */
+	const uint8_t *data;
+	/*! Number of valid bytes in data */
+	uint16_t length;
+	/*! Byte index of the next frame */
+	uint16_t idx;
+	/*! 0 - header-less mode, else header mode */
+	uint8_t header_enable;
+	/*! fifo_data_enable used for header-less frames */
+	uint8_t data_enable;
+};
+
+/*!
+ * @brief View of one FIFO frame. The mag/gyro/accel pointers point
+ * directly into the FIFO buffer and are NULL if the frame has no such
+ * payload; they stay valid until the buffer is refilled.
+ */
+struct bmi160_fifo_view {
+	/*! Kind of the frame */
+	enum bmi160_fifo_frame_kind kind;
+	/*! Raw aux payload (8 bytes) */
+	const uint8_t *mag;
+	/*! Raw gyro payload (6 bytes, x/y/z little endian) */
+	const uint8_t *gyro;
+	/*! Raw accel payload (6 bytes, x/y/z little endian) */
+	const uint8_t *accel;
+	/*! Sensor time, valid for BMI160_FIFO_FRAME_SENSORTIME */
+	uint32_t sensor_time;
+	/*! Skipped frame count, valid for BMI160_FIFO_FRAME_SKIP */
+	uint8_t skipped_frame_count;
+};
+
+/*!
+ * @brief Write-through shadow of the BMI160 configuration registers.
+ * Reads inside the cache window are served from here once a register
+ * has been read or written, and writes issued between
+ * bmi160_batch_begin() and bmi160_batch_commit() are coalesced into
+ * a single burst transfer.
+ */
+struct bmi160_reg_cache {
+	/*! Shadow of registers BMI160_CACHE_START_ADDR..BMI160_CACHE_END_ADDR */
+	uint8_t regs[BMI160_CACHE_LEN];
+	/*! Bit n is set when regs[n] mirrors the sensor */
+	uint64_t valid;
+	/*! Bit n is set when regs[n] holds a batched write not yet sent */
+	uint64_t dirty;
+	/*! Nesting depth of bmi160_batch_begin() */
+	uint8_t batch_depth;
+	/*! Number of bus transfers issued, for profiling */
+	uint32_t transfers;
+};
+
 struct bmi160_dev {
 	/*! Chip Id */
 	uint8_t chip_id;
@@ -1453,6 +1534,8 @@ struct bmi160_dev {
 	struct bmi160_aux_cfg prev_aux_cfg;
 	 /*! FIFO related configurations */
 	struct bmi160_fifo_frame *fifo;
+	/*! Optional register shadow cache, NULL disables caching */
+	struct bmi160_reg_cache *cache;
 	/*! Read function pointer */
 	bmi160_com_fptr_t read;
 	/*! Write function pointer */
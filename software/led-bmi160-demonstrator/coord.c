@@ -0,0 +1,71 @@
+/*
+ *  Copyright (c) 2018 Bastian Koppelmann Paderborn Univeristy
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include "coord.h"
+
+/* The part of the sensor-to-display pipeline that depends on coord_t.
+ * It has no hardware dependencies, so test/coord_test.c builds it on the
+ * host in both variants and compares them.
+ */
+
+void move_by_x(LEDCoordinates *led)
+{
+    coord_t nx = led->fx + led->delta_x;
+    if ( nx > COORD(0) && nx < COORD(32)) {
+        led->fx = nx;
+    }
+}
+
+void move_by_y(LEDCoordinates *led)
+{
+    coord_t ny = led->fy + led->delta_y;
+    if ( ny > COORD(0) && ny < COORD(8)) {
+        led->fy = ny;
+    }
+}
+
+/* One frame of the render task: follow the latest sample unless it is
+ * within the dead band around rest */
+void move_led(LEDCoordinates *led, coord_t delta_x, coord_t delta_y)
+{
+    led->delta_x = delta_x;
+    led->delta_y = delta_y;
+    if (led->delta_x > COORD(0.03) || led->delta_x < COORD(-0.03)) {
+        move_by_x(led);
+    }
+    if (led->delta_y > COORD(0.03) || led->delta_y < COORD(-0.03)) {
+        move_by_y(led);
+    }
+}
+
+coord_t smooth_data(int16_t x)
+{
+#ifdef USE_FIXED_POINT
+    /* x * 2^16 always fits into 32 bit for an int16_t */
+    return ((int32_t)x * (1 << COORD_FRAC_BITS)) / 17000;
+#else
+    return (x / 17000.0);
+#endif
+}
+
+/* small angle version of smooth_data() for a fused tilt angle:
+ * sin(a) * 16384 / 17000 ~= a * 0.9638 */
+coord_t smooth_angle(int32_t angle)
+{
+    return COORD_FROM_Q16((int32_t)(((int64_t)angle * 63161) >> 16));
+}
@@ -0,0 +1,44 @@
+#ifndef COORD_H
+#define COORD_H
+
+#include <stdint.h>
+
+/* Coordinate type of the sensor-to-display pipeline. The FE310 has no
+ * FPU, so by default everything is kept in Q16.16 fixed point and no
+ * soft-float routine is called per frame. Build with FIXED_POINT=0 to
+ * get the float reference implementation.
+ */
+#ifdef USE_FIXED_POINT
+typedef int32_t coord_t;
+#define COORD_FRAC_BITS 16
+#define COORD(v) ((coord_t)((v) * (1 << COORD_FRAC_BITS)))
+#define COORD_TO_INT(c) ((c) >> COORD_FRAC_BITS)
+#define COORD_FROM_Q16(q) ((coord_t)(q))
+/* Fault injection mask covering the integer part of a coordinate */
+#define COORD_FAULT_MASK 0x001f0000
+#else
+typedef float coord_t;
+#define COORD(v) ((coord_t)(v))
+#define COORD_TO_INT(c) ((int32_t)(c))
+#define COORD_FROM_Q16(q) ((coord_t)(q) / 65536.0f)
+/* Fault injection mask covering the exponent of a float coordinate */
+#define COORD_FAULT_MASK 0x41c00000
+#endif
+
+typedef struct {
+    coord_t delta_x, delta_y;
+    coord_t fx, fy;
+    uint8_t x, y;
+} LEDCoordinates;
+
+/* Moves the LED by delta_x/delta_y, unless that leaves the 32x8 matrix */
+void move_by_x(LEDCoordinates *led);
+void move_by_y(LEDCoordinates *led);
+/* Sets the deltas and moves by those outside the dead band */
+void move_led(LEDCoordinates *led, coord_t delta_x, coord_t delta_y);
+/* Raw BMI160 accel (2g range) to a movement per frame */
+coord_t smooth_data(int16_t x);
+/* Q16.16 radians tilt to a movement per frame */
+coord_t smooth_angle(int32_t angle);
+
+#endif
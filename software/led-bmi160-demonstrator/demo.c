@@ -27,12 +27,19 @@
 #include "UART_driver.h"
 #include "led-matrix.h"
 #include "bmi160.h"
+#include "coord.h"
+#include "fusion.h"
+#include "sched.h"
+#include "sifive/trace.h"
+#include "sifive/bench.h"
 
+#ifndef USE_FIXED_POINT
 asm (".global _printf_float");
+#endif
 
 /* this is global as this address is set up to be faulty */
-extern float *sensor_x_ptr;
-extern float *matrix_fx_ptr;
+extern coord_t *sensor_x_ptr;
+extern coord_t *matrix_fx_ptr;
 
 void delay_ms(uint32_t period)
 {
@@ -65,62 +72,142 @@ void config_sensors(struct bmi160_dev *sensor)
     rslt = bmi160_set_sens_conf(sensor);
 }
 
-void get_sensor_data(struct bmi160_dev *sensor, int16_t *x, int16_t *y, int16_t *z)
+void get_sensor_data(struct bmi160_dev *sensor, struct bmi160_sensor_data *accel,
+                     struct bmi160_sensor_data *gyro)
 {
     int8_t rslt = BMI160_OK;
-    struct bmi160_sensor_data accel;
-    struct bmi160_sensor_data gyro;
 
-    /* To read only Accel data */
-    rslt = bmi160_get_sensor_data(BMI160_ACCEL_SEL, &accel, NULL, sensor);
-
-    *x = accel.x;
-    *y = accel.y;
-    *z = accel.z;
+#ifdef USE_FUSION
+    /* Accel and gyro in one burst, sensortime gives the fusion dt */
+    rslt = bmi160_get_sensor_data(BMI160_ACCEL_SEL | BMI160_GYRO_SEL | BMI160_TIME_SEL,
+                                  accel, gyro, sensor);
+#else
+    rslt = bmi160_get_sensor_data(BMI160_ACCEL_SEL, accel, NULL, sensor);
+#endif
 }
 
 /* rendering code for the led-matrix */
 
-typedef struct {
-    float delta_x, delta_y;
-    float fx, fy;
-    uint8_t x, y;
-} LEDCoordinates;
-
 void render(LEDCoordinates *coord)
 {
-    coord->x = (uint8_t) coord->fx;
-    coord->y = (uint8_t) coord->fy;
+    coord->x = (uint8_t) COORD_TO_INT(coord->fx);
+    coord->y = (uint8_t) COORD_TO_INT(coord->fy);
+
+    clear_matrix();
+    set_point(coord->x, coord->y, 1);
+    draw_matrix();
+}
+
+/* State shared by the tasks. The sensor task fills the back half of
+ * buf[] and then flips front, so the render task always picks up the
+ * latest complete sample however the two task rates line up.
+ */
+typedef struct {
+    struct bmi160_dev *sensor;
+    fusion_state_t fusion;
+    uint32_t last_time;
+    /* written by the sensor task, sensor_x_ptr points here */
+    LEDCoordinates sensed;
+    LEDCoordinates buf[2];
+    volatile uint8_t front;
+    /* owned by the render task, matrix_fx_ptr points here */
+    LEDCoordinates led;
+    /* mcycle per frame since the last stats report */
+    uint32_t frames;
+    uint64_t frame_cycles;
+    uint32_t frame_cycles_max;
+} demo_state_t;
+
+/* BMI160_STATUS_ADDR bit 7: a new accel sample is ready */
+static uint8_t sensor_ready(void *arg)
+{
+    demo_state_t *s = arg;
+    uint8_t status = 0;
 
-    clear();
-    print_at(coord->x, coord->y);
+    bmi160_get_regs(BMI160_STATUS_ADDR, &status, 1, s->sensor);
+    return status & 0x80;
 }
 
-void move_by_x(LEDCoordinates *led)
+static void sensor_task(void *arg)
 {
-    float nx = led->fx + led->delta_x;
-    if ( nx > 0.0 && nx < 32.0) {
-        led->fx = nx;
+    demo_state_t *s = arg;
+    struct bmi160_sensor_data accel, gyro;
+    uint8_t back = 1 - s->front;
+
+    get_sensor_data(s->sensor, &accel, &gyro);
+#ifdef USE_FUSION
+    fusion_update(&s->fusion, &accel, &gyro, (accel.sensortime - s->last_time) & 0xffffff);
+    s->last_time = accel.sensortime;
+    s->sensed.delta_x = smooth_angle(-s->fusion.pitch);
+    s->sensed.delta_y = smooth_angle(s->fusion.roll);
+#else
+    s->sensed.delta_x = smooth_data(accel.x);
+    s->sensed.delta_y = smooth_data(accel.y);
+#endif
+
+    s->buf[back] = s->sensed;
+    s->front = back;
+}
+
+static void render_task(void *arg)
+{
+    demo_state_t *s = arg;
+    const LEDCoordinates *in = &s->buf[s->front];
+    uint64_t start = bench_cycles();
+    uint32_t cycles;
+
+    move_led(&s->led, in->delta_x, in->delta_y);
+    render(&s->led);
+
+    cycles = (uint32_t)(bench_cycles() - start);
+    s->frames++;
+    s->frame_cycles += cycles;
+    if (cycles > s->frame_cycles_max) {
+        s->frame_cycles_max = cycles;
     }
 }
 
-void move_by_y(LEDCoordinates *led)
+static void stats_task(void *arg)
 {
-    float ny = led->fy + led->delta_y;
-    if ( ny > 0.0 && ny < 8.0) {
-        led->fy = ny;
+    demo_state_t *s = arg;
+
+    sched_report();
+    if (s->frames) {
+        printf("frame    cycles avg %lu max %lu\n",
+               (unsigned long)(s->frame_cycles / s->frames),
+               (unsigned long)s->frame_cycles_max);
     }
+    s->frames = 0;
+    s->frame_cycles = 0;
+    s->frame_cycles_max = 0;
 }
 
-float smooth_data(int16_t x)
+/* prints what the button handlers logged with TRACE() */
+static void trace_task(void *arg)
 {
-    return (x / 17000.0);
+    (void)arg;
+    trace_drain();
 }
 
+/* accel ODR from config_sensors() and the matrix refresh rate */
+#define SENSOR_HZ 1600
+#define RENDER_HZ 60
+
 int main()
 {
-    int16_t x, y, z;
+    static demo_state_t state;
     struct bmi160_dev sensor;
+    static struct bmi160_reg_cache sensor_cache;
+    static sched_task_t tasks[] = {
+        /* polled at twice the ODR, a miss is a sample found more than two
+         * sample periods after the previous poll or read, e.g. one that
+         * waited behind the render or stats task */
+        { "sensor", sensor_task, sensor_ready, &state,
+          SCHED_HZ(2 * SENSOR_HZ), 2 * SCHED_HZ(SENSOR_HZ) },
+        { "render", render_task, NULL, &state, SCHED_HZ(RENDER_HZ), 0 },
+        { "stats", stats_task, NULL, &state, 2 * RTC_FREQ, 0 },
+        { "trace", trace_task, NULL, NULL, SCHED_HZ(10), 0 },
+    };
 
     UART_init(115200, 0);
 
@@ -132,30 +219,25 @@ int main()
     sensor.read = &spi_read;
     sensor.write = &spi_write;
     sensor.delay_ms = &delay_ms;
+    sensor.cache = &sensor_cache;
 
     bmi160_init(&sensor);
     config_sensors(&sensor);
     init_plic();
 
-    LEDCoordinates led;
-    led.fx = 15.0;
-    led.fy = 7.0;
-    sensor_x_ptr = &led.delta_x;
-    matrix_fx_ptr = &led.fx;
-    while (1) {
-        // for safety measures:
-        // LEDCoordinates led_dup = led; // should be led_dup(led)
-        get_sensor_data(&sensor, &x, &y, &z);
-        led.delta_x = smooth_data(x);
-        led.delta_y = smooth_data(y);
-
-        if (led.delta_x > 0.03 || led.delta_x < -0.03) {
-            move_by_x(&led);
-        }
-        if (led.delta_y > 0.03 || led.delta_y < -0.03) {
-            move_by_y(&led);
-        }
-        render(&led);
-    }
+    state.sensor = &sensor;
+#ifdef USE_FUSION
+    /* matches BMI160_GYRO_RANGE_2000_DPS from config_sensors(), alpha 0.98 */
+    fusion_init(&state.fusion, 2000, 64225);
+    state.last_time = 0;
+#endif
+
+    state.led.fx = COORD(15);
+    state.led.fy = COORD(7);
+    sensor_x_ptr = &state.sensed.delta_x;
+    matrix_fx_ptr = &state.led.fx;
+
+    sched_init(tasks, sizeof(tasks) / sizeof(tasks[0]));
+    sched_run();
     return 0;
 }
@@ -2,11 +2,14 @@
 #include "plic/plic_driver.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include "coord.h"
+#include "UART_driver.h"
+#include "sifive/trace.h"
 
 static uint8_t float_stuck = 0;
 static uint8_t random_flip = 0;
-float *sensor_x_ptr;
-float *matrix_fx_ptr;
+coord_t *sensor_x_ptr;
+coord_t *matrix_fx_ptr;
 
 /* fault activation code:
  * This is activated using the buttons 0 and 1 on the arty board
@@ -20,7 +23,7 @@ plic_instance_t g_plic;
 static void button_0_handler(void)
 {
     float_stuck = 1 - float_stuck;
-    printf("Float_stuck = %d\n", float_stuck);
+    TRACE("Float_stuck = %d\n", float_stuck);
     uint32_t csr_val = read_csr(0xbc4);
 
     /* Custom fault injection registers:
@@ -45,7 +48,7 @@ static void button_0_handler(void)
 static void button_1_handler(void)
 {
     random_flip = 1 - random_flip;
-    printf("random flip = %d\n", random_flip);
+    TRACE("random flip = %d\n", random_flip);
     uint32_t csr_val = read_csr(0xbc4);
 
     /* 0xbc2 is the address register
@@ -54,7 +57,7 @@ static void button_1_handler(void)
      * the bits indicated on the mask are returned
      */
     write_csr(0xbc2, matrix_fx_ptr);
-    write_csr(0xbc3, 0x41c00000);
+    write_csr(0xbc3, COORD_FAULT_MASK);
     if (random_flip) {
         csr_val |= 2;
     } else {
@@ -96,6 +99,12 @@ void init_plic(void)
     GPIO_REG(GPIO_RISE_IE) |= (1 << BUTTON_0_OFFSET);
     GPIO_REG(GPIO_RISE_IE) |= (1 << BUTTON_1_OFFSET);
 
+    // Move UART0 receive from polling to the RX watermark interrupt
+    g_ext_interrupt_handlers[INT_UART0_BASE] = UART_rx_isr;
+    PLIC_enable_interrupt (&g_plic, INT_UART0_BASE);
+    PLIC_set_priority(&g_plic, INT_UART0_BASE, 1);
+    UART_rx_irq(1);
+
     // Enable the Machine-External bit in MIE
     set_csr(mie, MIP_MEIP);
 
@@ -0,0 +1,136 @@
+/*
+ *  Copyright (c) 2018 Bastian Koppelmann Paderborn Univeristy
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include "fusion.h"
+
+#define Q16_PI      205887      /* pi in Q16.16 */
+#define Q16_HALF_PI 102944
+
+/* pi / 180 * 2^25, turns dps/32768 into rad in Q40 */
+#define DEG_TO_RAD_Q25 585636
+
+/* atan(2^-i) in Q16.16 radians */
+static const int32_t cordic_atan[16] = {
+    51472, 30386, 16055, 8150, 4091, 2047, 1024, 512,
+    256, 128, 64, 32, 16, 8, 4, 2
+};
+
+/* Four quadrant arctangent in Q16.16 radians using CORDIC vectoring */
+int32_t fusion_atan2(int32_t y, int32_t x)
+{
+    int32_t angle = 0;
+    int32_t xn;
+
+    if (x == 0 && y == 0) {
+        return 0;
+    }
+
+    /* rotate into the right half plane first */
+    if (x < 0) {
+        angle = (y >= 0) ? Q16_PI : -Q16_PI;
+        x = -x;
+        y = -y;
+    }
+
+    /* leave head room for the CORDIC gain of ~1.65 */
+    x <<= 8;
+    y <<= 8;
+
+    for (int i = 0; i < 16; i++) {
+        if (y > 0) {
+            xn = x + (y >> i);
+            y -= x >> i;
+            x = xn;
+            angle += cordic_atan[i];
+        } else {
+            xn = x - (y >> i);
+            y += x >> i;
+            x = xn;
+            angle -= cordic_atan[i];
+        }
+    }
+
+    return angle;
+}
+
+static uint32_t isqrt(uint32_t v)
+{
+    uint32_t res = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= res + bit) {
+            v -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+void fusion_init(fusion_state_t *f, uint32_t gyro_range_dps, int32_t alpha)
+{
+    f->roll = 0;
+    f->pitch = 0;
+    f->alpha = alpha;
+    f->gyro_scale = (gyro_range_dps * DEG_TO_RAD_Q25) / FUSION_SENSORTIME_HZ;
+    f->initialized = 0;
+}
+
+static int32_t blend(const fusion_state_t *f, int32_t gyro_angle, int32_t acc_angle)
+{
+    int32_t err = acc_angle - gyro_angle;
+
+    /* take the short way around at the +-pi seam */
+    if (err > Q16_PI) {
+        err -= 2 * Q16_PI;
+    } else if (err < -Q16_PI) {
+        err += 2 * Q16_PI;
+    }
+    return gyro_angle + ((err * (65536 - f->alpha)) >> 16);
+}
+
+void fusion_update(fusion_state_t *f, const struct bmi160_sensor_data *accel,
+                   const struct bmi160_sensor_data *gyro, uint32_t dt)
+{
+    int32_t ax = accel->x, ay = accel->y, az = accel->z;
+    int32_t acc_roll, acc_pitch;
+    int32_t roll, pitch;
+
+    acc_roll = fusion_atan2(ay, az);
+    acc_pitch = fusion_atan2(-ax, isqrt((uint32_t)(ay * ay) + (uint32_t)(az * az)));
+
+    if (!f->initialized) {
+        f->roll = acc_roll;
+        f->pitch = acc_pitch;
+        f->initialized = 1;
+        return;
+    }
+
+    /* integrate the gyro rate: LSB * Q40 rad/tick * ticks >> 24 = Q16 */
+    roll = f->roll + (int32_t)(((int64_t)gyro->x * f->gyro_scale * dt) >> 24);
+    pitch = f->pitch + (int32_t)(((int64_t)gyro->y * f->gyro_scale * dt) >> 24);
+
+    f->roll = blend(f, roll, acc_roll);
+    f->pitch = blend(f, pitch, acc_pitch);
+}
@@ -43,9 +43,84 @@
 #define HIGH 1
 #define LOW 0
 
-const int num_matrices = 4;
-uint8_t matrix[32][8];
+#define NUM_MATRICES 4
 
+const int num_matrices = NUM_MATRICES;
+
+/* Framebuffer: one byte per MAX7219 digit register, bit 7 - (x % 8) of
+ * frame[x / 8][y] is pixel (x, y). shown[][] mirrors what the display
+ * currently holds so draw_matrix() only sends the digits that changed.
+ */
+static uint8_t frame[NUM_MATRICES][8];
+static uint8_t shown[NUM_MATRICES][8];
+
+#ifdef USE_MATRIX_SPI
+/* SPI2 backend: MOSI drives DIN, SCK drives CLK and SS0 drives CS, on
+ * GPIO 27, 29 and 26 rather than the pins 2-4 of the default wiring. One
+ * transfer is num_matrices * 2 bytes, which fits the 8 entry TX FIFO, so
+ * a whole transfer is queued without waiting for the shifter. CS is held
+ * for the transfer and only released once the last byte has been shifted
+ * out, which the RX FIFO tells us (the controller runs full duplex and
+ * receives one byte per byte sent).
+ */
+#define MATRIX_SPI_HZ 10000000
+#define MATRIX_SPI_IOF_MASK ((1 << IOF_SPI2_SS0) | (1 << IOF_SPI2_MOSI) | \
+                             (1 << IOF_SPI2_SCK))
+
+static uint32_t pending;
+
+static uint32_t begin_transfer(void)
+{
+    SPI2_REG(SPI_REG_CSMODE) = SPI_CSMODE_HOLD;
+    pending = 0;
+    return 0;
+}
+
+static void end_transfer(uint32_t base)
+{
+    (void)base;
+    while (pending) {
+        if ((int32_t)SPI2_REG(SPI_REG_RXFIFO) >= 0) {
+            pending--;
+        }
+    }
+    /* the MAX7219s latch their shift registers on the rising CS edge */
+    SPI2_REG(SPI_REG_CSMODE) = SPI_CSMODE_AUTO;
+}
+
+static void send_byte(uint32_t base, uint8_t b)
+{
+    (void)base;
+    while (SPI2_REG(SPI_REG_TXFIFO) & SPI_TXFIFO_FULL)
+        ;
+    SPI2_REG(SPI_REG_TXFIFO) = b;
+    pending++;
+}
+
+static void setup_matrix_pins(void)
+{
+    unsigned long div = (get_cpu_freq() + 2 * MATRIX_SPI_HZ - 1) /
+                        (2 * MATRIX_SPI_HZ);
+
+    SPI2_REG(SPI_REG_SCKDIV) = div ? div - 1 : 0;
+    SPI2_REG(SPI_REG_SCKMODE) = 0;
+    SPI2_REG(SPI_REG_CSID) = 0;
+    SPI2_REG(SPI_REG_CSDEF) = 0xffff;
+    SPI2_REG(SPI_REG_CSMODE) = SPI_CSMODE_AUTO;
+    SPI2_REG(SPI_REG_FMT) = SPI_FMT_PROTO(SPI_PROTO_S) |
+                            SPI_FMT_ENDIAN(SPI_ENDIAN_MSB) |
+                            SPI_FMT_DIR(SPI_DIR_RX) |
+                            SPI_FMT_LEN(8);
+    SPI2_REG(SPI_REG_IE) = 0;
+
+    /* drop anything left in the RX FIFO */
+    while ((int32_t)SPI2_REG(SPI_REG_RXFIFO) >= 0)
+        ;
+
+    GPIO_REG(GPIO_IOF_SEL) &= ~MATRIX_SPI_IOF_MASK;
+    GPIO_REG(GPIO_IOF_EN) |= MATRIX_SPI_IOF_MASK;
+}
+#else
 void set_pin(uint32_t pin, uint8_t val)
 {
     if (val == 0) {
@@ -55,55 +130,88 @@ void set_pin(uint32_t pin, uint8_t val)
     }
 }
 
-void send_byte(uint8_t b)
+/* Pull CS low and return the GPIO output value with DIN, CLK and CS low.
+ * The bit-banging below writes GPIO_OUTPUT_VAL from this value instead of
+ * doing a read-modify-write per pin change, so nothing else may change
+ * other output pins while a transfer is in progress.
+ */
+static uint32_t begin_transfer(void)
+{
+    uint32_t base = GPIO_REG(GPIO_OUTPUT_VAL) & ~(BIT(DIN) | BIT(CLK) | BIT(CS));
+
+    GPIO_REG(GPIO_OUTPUT_VAL) = base;
+    return base;
+}
+
+static void end_transfer(uint32_t base)
+{
+    /* the MAX7219s latch their shift registers on the rising CS edge */
+    GPIO_REG(GPIO_OUTPUT_VAL) = base | BIT(CS);
+}
+
+/* one GPIO write per clock edge, DIN is sampled on the rising edge */
+static void send_byte(uint32_t base, uint8_t b)
 {
     for (int i = 7; i >= 0; i--) {
-        set_pin(DIN, (b >> i) & 1);
-        set_pin(CLK, HIGH);
-        set_pin(CLK, LOW);
+        uint32_t val = base | (((b >> i) & 1) << DIN);
+        GPIO_REG(GPIO_OUTPUT_VAL) = val;
+        GPIO_REG(GPIO_OUTPUT_VAL) = val | BIT(CLK);
     }
 }
 
+static void setup_matrix_pins(void)
+{
+    GPIO_REG(GPIO_OUTPUT_EN) |= BIT(PIN_2_OFFSET);
+    GPIO_REG(GPIO_INPUT_EN) &= ~BIT(PIN_2_OFFSET);
+
+    GPIO_REG(GPIO_OUTPUT_EN) |= BIT(PIN_3_OFFSET);
+    GPIO_REG(GPIO_INPUT_EN) &= ~BIT(PIN_3_OFFSET);
+
+    GPIO_REG(GPIO_OUTPUT_EN) |= BIT(PIN_4_OFFSET);
+    GPIO_REG(GPIO_INPUT_EN) &= ~BIT(PIN_4_OFFSET);
+
+    set_pin(CS, HIGH);
+}
+#endif
+
 void send_command(uint8_t cmd, uint8_t val)
 {
-    set_pin(CS, LOW);
+    uint32_t base = begin_transfer();
     for(int i=0; i < num_matrices; i++) {
-        send_byte(cmd);
-        send_byte(val);
+        send_byte(base, cmd);
+        send_byte(base, val);
     }
-    set_pin(CS, HIGH);
+    end_transfer(base);
 }
 
-#define assign_bit(res, n, v) do {\
-    res ^= (-v ^ res) & (1UL << n); \
-} while (0)
-
 void set_column(uint8_t col, uint8_t val)
 {
     uint8_t n = col / 8;
     uint8_t c = col % 8;
 
-    set_pin(CS, LOW);
+    uint32_t base = begin_transfer();
     for (int i=0; i < num_matrices; i++) {
         if (i == n) {
-            send_byte(c + 1);
-            send_byte(val);
+            send_byte(base, c + 1);
+            send_byte(base, val);
         } else {
-            send_byte(0);
-            send_byte(0);
+            send_byte(base, max7219_reg_noop);
+            send_byte(base, 0);
         }
     }
-    set_pin(CS, HIGH);
+    end_transfer(base);
+    frame[n][c] = shown[n][c] = val;
 }
 
 void set_column_all(uint8_t col, uint8_t val)
 {
-    set_pin(CS, LOW);
+    uint32_t base = begin_transfer();
     for (int i=0; i<num_matrices; i++) {
-        send_byte(col + 1);
-        send_byte(val);
+        send_byte(base, col + 1);
+        send_byte(base, val);
+        frame[i][col] = shown[i][col] = val;
     }
-    set_pin(CS, HIGH);
+    end_transfer(base);
 }
 
 void clear(void)
@@ -120,16 +228,7 @@ void set_intensity(uint8_t intensity)
 
 void setup_matrix(void)
 {
-    GPIO_REG(GPIO_OUTPUT_EN) |= BIT(PIN_2_OFFSET);
-    GPIO_REG(GPIO_INPUT_EN) &= ~BIT(PIN_2_OFFSET);
-
-    GPIO_REG(GPIO_OUTPUT_EN) |= BIT(PIN_3_OFFSET);
-    GPIO_REG(GPIO_INPUT_EN) &= ~BIT(PIN_3_OFFSET);
-
-    GPIO_REG(GPIO_OUTPUT_EN) |= BIT(PIN_4_OFFSET);
-    GPIO_REG(GPIO_INPUT_EN) &= ~BIT(PIN_4_OFFSET);
-
-    set_pin(CS, HIGH);
+    setup_matrix_pins();
 
     send_command(max7219_reg_scanLimit, 0x07);
     send_command(max7219_reg_decodeMode, 0x00);
@@ -149,26 +248,57 @@ void print_at(uint32_t x, uint32_t y)
     set_column(y + 8 * yf, val);
 }
 
+/* Framebuffer interface: set_point()/clear_matrix() only touch RAM,
+ * draw_matrix() pushes the changes to the display.
+ */
+void clear_matrix(void)
+{
+    for (int m = 0; m < NUM_MATRICES; m++) {
+        for (int d = 0; d < 8; d++) {
+            frame[m][d] = 0;
+        }
+    }
+}
+
 void set_point(uint32_t x, uint32_t y, uint8_t val)
 {
-    if ( (x < 32 && x >= 0) && ((y < 8) && (y >=0)) ) {
-        matrix[x][y] = val;
+    if (x < 8 * NUM_MATRICES && y < 8) {
+        uint8_t bit = 1 << (7 - (x % 8));
+        if (val) {
+            frame[x / 8][y] |= bit;
+        } else {
+            frame[x / 8][y] &= ~bit;
+        }
     }
 }
 
-void draw_matrix()
+/* Send every digit register that differs from the display. One transfer
+ * per dirty digit covers all modules; modules whose digit is unchanged
+ * get a no-op.
+ */
+void draw_matrix(void)
 {
-    uint32_t yf, x, y;
-    uint8_t val;
+    for (int d = 0; d < 8; d++) {
+        uint8_t dirty = 0;
+
+        for (int m = 0; m < NUM_MATRICES; m++) {
+            dirty |= frame[m][d] ^ shown[m][d];
+        }
+        if (!dirty) {
+            continue;
+        }
 
-    for (int dy=0; dy < 32; dy++) {
-        for (int dx = 0; dx < 8; dx++) {
-            yf = dy / 8;
-            y = dy % 8;
-            x = (8 - dx) + (yf * 8);
-            if (matrix[x][y] == 0) {
-                assign_bit(val, matrix[x][y], x);
+        uint32_t base = begin_transfer();
+        for (int m = 0; m < NUM_MATRICES; m++) {
+            if (frame[m][d] != shown[m][d]) {
+                send_byte(base, d + 1);
+                send_byte(base, frame[m][d]);
+                shown[m][d] = frame[m][d];
+            } else {
+                send_byte(base, max7219_reg_noop);
+                send_byte(base, 0);
             }
         }
+        end_transfer(base);
     }
 }
@@ -1,3 +1,6 @@
 void setup_matrix(void);
 void clear(void);
 void print_at(uint32_t x, uint32_t y);
+void clear_matrix(void);
+void set_point(uint32_t x, uint32_t y, uint8_t val);
+void draw_matrix(void);
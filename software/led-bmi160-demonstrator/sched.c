@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2018 Bastian Koppelmann Paderborn Univeristy
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "platform.h"
+#include "encoding.h"
+#include "sched.h"
+
+static sched_task_t *sched_tasks;
+static uint32_t sched_num_tasks;
+/* mcycle at the start of the statistics window */
+static uint32_t window_start;
+
+static uint64_t mtime_now(void)
+{
+    volatile uint32_t *mtime = (uint32_t *)(CLINT_CTRL_ADDR + CLINT_MTIME);
+    uint32_t hi, lo;
+
+    do {
+        hi = mtime[1];
+        lo = mtime[0];
+    } while (hi != mtime[1]);
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static void sleep_until(uint64_t when)
+{
+    volatile uint32_t *mtimecmp = (uint32_t *)(CLINT_CTRL_ADDR + CLINT_MTIMECMP);
+
+    /* park the low word at all ones while the high word changes so no
+     * intermediate compare value fires */
+    mtimecmp[0] = 0xffffffff;
+    mtimecmp[1] = (uint32_t)(when >> 32);
+    mtimecmp[0] = (uint32_t)when;
+
+    set_csr(mie, MIP_MTIP);
+    while (mtime_now() < when) {
+        asm volatile ("wfi");
+    }
+}
+
+/* only wakes up the wfi in sleep_until(), the compare value is
+ * rewritten on the next sleep */
+void handle_m_time_interrupt(void)
+{
+    clear_csr(mie, MIP_MTIP);
+}
+
+void sched_init(sched_task_t *tasks, uint32_t num_tasks)
+{
+    uint64_t now = mtime_now();
+
+    sched_tasks = tasks;
+    sched_num_tasks = num_tasks;
+    for (uint32_t i = 0; i < num_tasks; i++) {
+        tasks[i].next = now;
+        tasks[i].release = now;
+        tasks[i].busy_cycles = 0;
+        tasks[i].runs = 0;
+        tasks[i].misses = 0;
+    }
+    window_start = read_csr(mcycle);
+}
+
+/* Run one task if it is due, returns whether it ran */
+static uint8_t sched_dispatch(sched_task_t *t, uint64_t now)
+{
+    uint32_t start, end;
+
+    if (now < t->next) {
+        return 0;
+    }
+    if (t->ready) {
+        if (!t->ready(t->arg)) {
+            t->release = now;
+            t->next = now + t->period;
+            return 0;
+        }
+        /* the event came after the release, e.g. while other tasks ran */
+        if (now - t->release > t->deadline) {
+            t->misses++;
+        }
+    }
+
+    start = read_csr(mcycle);
+    t->run(t->arg);
+    end = read_csr(mcycle);
+    t->busy_cycles += end - start;
+    t->runs++;
+
+    now = mtime_now();
+    if (t->ready) {
+        t->release = now;
+        t->next = now + t->period;
+    } else {
+        t->next += t->period;
+        if (now > t->next) {
+            /* overran into the next slot, drop the releases we missed */
+            t->misses++;
+            t->next += ((now - t->next) / t->period + 1) * t->period;
+        }
+    }
+    return 1;
+}
+
+void sched_run(void)
+{
+    while (1) {
+        uint64_t now = mtime_now();
+        uint64_t wake = UINT64_MAX;
+        uint8_t ran = 0;
+
+        for (uint32_t i = 0; i < sched_num_tasks; i++) {
+            ran |= sched_dispatch(&sched_tasks[i], now);
+        }
+        if (ran) {
+            continue;
+        }
+        for (uint32_t i = 0; i < sched_num_tasks; i++) {
+            if (sched_tasks[i].next < wake) {
+                wake = sched_tasks[i].next;
+            }
+        }
+        sleep_until(wake);
+    }
+}
+
+/* Print CPU utilization in 0.1% steps and deadline misses per task since
+ * the previous report, then start a new window. Meant to be called from
+ * a (low rate) task itself.
+ */
+void sched_report(void)
+{
+    uint32_t now = read_csr(mcycle);
+    uint32_t window = now - window_start;
+
+    if (window == 0) {
+        return;
+    }
+    for (uint32_t i = 0; i < sched_num_tasks; i++) {
+        sched_task_t *t = &sched_tasks[i];
+        uint32_t permille = (uint32_t)(t->busy_cycles * 1000 / window);
+
+        printf("%-8s %3u.%u%% runs %5u misses %u\n", t->name,
+               (unsigned)(permille / 10), (unsigned)(permille % 10),
+               (unsigned)t->runs, (unsigned)t->misses);
+        t->busy_cycles = 0;
+        t->runs = 0;
+        t->misses = 0;
+    }
+    window_start = now;
+}
@@ -0,0 +1,45 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+/* Cooperative run-to-completion scheduler paced by the CLINT timer.
+ *
+ * Times are CLINT mtime ticks (RTC_FREQ per second). A periodic task
+ * (ready == NULL) is released every period ticks and misses its
+ * deadline when it finishes after its next release. An event task
+ * (ready != NULL) is polled every period ticks and run when ready()
+ * returns non-zero. It is released by every poll that finds ready()
+ * false and at the end of every run, and misses its deadline when a
+ * poll finds it ready more than deadline ticks after its release, i.e.
+ * when the event may have waited that long. When no task is due the hart
+ * sleeps in wfi until the earliest release.
+ *
+ * Utilization is counted in mcycle, which wraps after ~66 s at 65 MHz,
+ * so sched_report() has to be called more often than that.
+ */
+
+#define SCHED_HZ(hz) ((RTC_FREQ + (hz) / 2) / (hz))
+
+typedef struct {
+    const char *name;
+    void (*run)(void *arg);
+    uint8_t (*ready)(void *arg);
+    void *arg;
+    uint32_t period;
+    uint32_t deadline;
+
+    /* scheduler state */
+    uint64_t next;
+    uint64_t release;
+    /* statistics since the last sched_report() */
+    uint64_t busy_cycles;
+    uint32_t runs;
+    uint32_t misses;
+} sched_task_t;
+
+void sched_init(sched_task_t *tasks, uint32_t num_tasks);
+void sched_run(void);
+void sched_report(void);
+
+#endif
@@ -0,0 +1,3 @@
+#define USE_FIXED_POINT
+#define VARIANT(name) fixed_##name
+#include "coord_variant.c"
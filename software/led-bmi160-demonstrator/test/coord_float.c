@@ -0,0 +1,2 @@
+#define VARIANT(name) float_##name
+#include "coord_variant.c"
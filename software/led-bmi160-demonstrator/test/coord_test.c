@@ -0,0 +1,157 @@
+// See LICENSE for license details.
+
+// Host test of coord.c: runs the Q16.16 build (FIXED_POINT=1) and the
+// float reference (FIXED_POINT=0) over the same inputs and compares.
+//
+// Bit-exact agreement is not possible, smooth_data() truncates to
+// 2^-16 where the float build rounds to 24 bits. What has to hold:
+// - for every int16_t input smooth_data() differs by at most 2^-16
+//   plus the rounding of the float, and both builds agree on the dead
+//   band of move_led()
+// - a frame started from the same position ends within 2^-15 in both
+//   builds. It only ends on another LED, or only clamps at the border
+//   in one of them, where the float build is that close to the edge.
+//
+// Free running, the builds drift apart by up to 2^-16 per frame, and
+// once one of them clamps at the border of the matrix and the other
+// does not, by up to a whole move. How often that shows is printed.
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "coord_test.h"
+
+#define LSB (1.0 / 65536)
+#define DEAD_BAND 0.03
+#define FRAMES 4000
+
+static int failures;
+
+#define CHECK(cond, ...)                        \
+    do {                                        \
+        if (!(cond)) {                          \
+            printf("FAIL: " __VA_ARGS__);       \
+            printf("\n");                       \
+            failures++;                         \
+        }                                       \
+    } while (0)
+
+static int moves(double delta)
+{
+    return delta > DEAD_BAND || delta < -DEAD_BAND;
+}
+
+static void check_smooth(void)
+{
+    double worst = 0;
+
+    for (int32_t x = INT16_MIN; x <= INT16_MAX; x++) {
+        double f = fixed_smooth((int16_t)x);
+        double r = float_smooth((int16_t)x);
+
+        if (fabs(f - r) > worst) {
+            worst = fabs(f - r);
+        }
+        /* truncation in one, float rounding in the other */
+        CHECK(fabs(f - r) < LSB + fabs(r) * FLT_EPSILON, "smooth_data(%d): %.9f != %.9f", x, f, r);
+        CHECK(moves(f) == moves((float)r) || fabs(fabs(r) - DEAD_BAND) < LSB,
+              "smooth_data(%d): dead band %d != %d", x, moves(f), moves(r));
+    }
+    printf("smooth_data  all int16_t, max error %.3f LSB\n", worst / LSB);
+}
+
+/* distance of v to the nearest pixel edge */
+static double edge_distance(double v)
+{
+    double frac = v - floor(v);
+
+    return frac < 0.5 ? frac : 1 - frac;
+}
+
+/* whether fixed and ref of one axis are as close as they have to be.
+ * from is where the frame started, size the size of the matrix on it */
+static int axis_agrees(double fixed, double ref, double from, double delta,
+                       double size)
+{
+    double to = from + delta;
+
+    if (fabs(to) <= 2 * LSB || fabs(to - size) <= 2 * LSB) {
+        /* the clamp may go either way */
+        return fabs(fixed - ref) <= 2 * LSB || fabs(fixed - from) <= 2 * LSB;
+    }
+    if (fabs(fixed - ref) > 2 * LSB) {
+        return 0;
+    }
+    return (int)floor(fixed) == (int)floor(ref) || edge_distance(ref) <= 2 * LSB;
+}
+
+static void check_run(const char *name, const int16_t (*accel)[2])
+{
+    static struct coord_frame free_fixed[FRAMES], ref[FRAMES];
+    double from_x = 15, from_y = 7, worst = 0;
+    int pixels = 0;
+
+    float_run(accel, FRAMES, ref);
+    for (int i = 0; i < FRAMES; i++) {
+        struct coord_frame f, r;
+
+        fixed_step(from_x, from_y, accel[i], &f);
+        float_step(from_x, from_y, accel[i], &r);
+        CHECK(r.fx == ref[i].fx && r.fy == ref[i].fy,
+              "%s frame %d: float step does not repeat the run", name, i);
+        CHECK(axis_agrees(f.fx, r.fx, from_x, r.delta_x, 32),
+              "%s frame %d: fx %.6f != %.6f from %.6f", name, i, f.fx, r.fx, from_x);
+        CHECK(axis_agrees(f.fy, r.fy, from_y, r.delta_y, 8),
+              "%s frame %d: fy %.6f != %.6f from %.6f", name, i, f.fy, r.fy, from_y);
+        from_x = r.fx;
+        from_y = r.fy;
+    }
+
+    fixed_run(accel, FRAMES, free_fixed);
+    for (int i = 0; i < FRAMES; i++) {
+        worst = fmax(worst, fmax(fabs(free_fixed[i].fx - ref[i].fx),
+                                 fabs(free_fixed[i].fy - ref[i].fy)));
+        pixels += free_fixed[i].x != ref[i].x || free_fixed[i].y != ref[i].y;
+    }
+    printf("%-12s %d frames, free running: max distance %.4f, %d frames on another LED\n",
+           name, FRAMES, worst, pixels);
+}
+
+int main(void)
+{
+    static int16_t accel[FRAMES][2];
+    uint32_t seed = 1;
+
+    check_smooth();
+
+    /* the board tilted back and forth on both axes */
+    for (int i = 0; i < FRAMES; i++) {
+        accel[i][0] = (int16_t)(6000 * sin(i * 0.004));
+        accel[i][1] = (int16_t)(3000 * sin(i * 0.011 + 1));
+    }
+    check_run("tilt", (const int16_t (*)[2])accel);
+
+    /* held against the edges of the matrix */
+    for (int i = 0; i < FRAMES; i++) {
+        accel[i][0] = (i / 500) & 1 ? -9000 : 9000;
+        accel[i][1] = (i / 700) & 1 ? 4000 : -4000;
+    }
+    check_run("edges", (const int16_t (*)[2])accel);
+
+    /* hand held noise around rest, mostly inside the dead band */
+    for (int i = 0; i < FRAMES; i++) {
+        for (int axis = 0; axis < 2; axis++) {
+            seed = seed * 1664525 + 1013904223;
+            accel[i][axis] = (int16_t)((int32_t)(seed >> 16) % 1200 - 600);
+        }
+    }
+    check_run("noise", (const int16_t (*)[2])accel);
+
+    if (failures) {
+        printf("coord_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("coord_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef COORD_TEST_H
+#define COORD_TEST_H
+
+#include <stdint.h>
+
+/* What one build of coord.c made of one accel sample, in doubles so the
+ * fixed point and the float build can be compared */
+struct coord_frame {
+    double delta_x, delta_y;
+    double fx, fy;
+    uint8_t x, y;
+};
+
+/* smooth_data() of x as a double */
+double fixed_smooth(int16_t x);
+double float_smooth(int16_t x);
+/* Feeds n accel x/y samples through smooth_data() and move_led() from
+ * the demo's start position, one frame per sample */
+void fixed_run(const int16_t (*accel)[2], int n, struct coord_frame *out);
+void float_run(const int16_t (*accel)[2], int n, struct coord_frame *out);
+/* One frame of the same from the LED position fx, fy */
+void fixed_step(double fx, double fy, const int16_t accel[2], struct coord_frame *out);
+void float_step(double fx, double fy, const int16_t accel[2], struct coord_frame *out);
+
+#endif
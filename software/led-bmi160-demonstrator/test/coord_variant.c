@@ -0,0 +1,53 @@
+/* coord.c built under the names VARIANT(...), included by coord_fixed.c
+ * and coord_float.c so both variants link into one test */
+
+#define move_by_x VARIANT(move_by_x)
+#define move_by_y VARIANT(move_by_y)
+#define move_led VARIANT(move_led)
+#define smooth_data VARIANT(smooth_data)
+#define smooth_angle VARIANT(smooth_angle)
+
+#include <math.h>
+#include "../coord.c"
+#include "coord_test.h"
+
+#ifdef USE_FIXED_POINT
+#define COORD_TO_DOUBLE(c) ((c) / (double)(1 << COORD_FRAC_BITS))
+#define COORD_FROM_DOUBLE(v) ((coord_t)lround((v) * (1 << COORD_FRAC_BITS)))
+#else
+#define COORD_TO_DOUBLE(c) ((double)(c))
+#define COORD_FROM_DOUBLE(v) ((coord_t)(v))
+#endif
+
+static void frame_of(const LEDCoordinates *led, struct coord_frame *out)
+{
+    out->delta_x = COORD_TO_DOUBLE(led->delta_x);
+    out->delta_y = COORD_TO_DOUBLE(led->delta_y);
+    out->fx = COORD_TO_DOUBLE(led->fx);
+    out->fy = COORD_TO_DOUBLE(led->fy);
+    out->x = (uint8_t)COORD_TO_INT(led->fx);
+    out->y = (uint8_t)COORD_TO_INT(led->fy);
+}
+
+double VARIANT(smooth)(int16_t x)
+{
+    return COORD_TO_DOUBLE(smooth_data(x));
+}
+
+void VARIANT(run)(const int16_t (*accel)[2], int n, struct coord_frame *out)
+{
+    LEDCoordinates led = { .fx = COORD(15), .fy = COORD(7) };
+
+    for (int i = 0; i < n; i++) {
+        move_led(&led, smooth_data(accel[i][0]), smooth_data(accel[i][1]));
+        frame_of(&led, &out[i]);
+    }
+}
+
+void VARIANT(step)(double fx, double fy, const int16_t accel[2], struct coord_frame *out)
+{
+    LEDCoordinates led = { .fx = COORD_FROM_DOUBLE(fx), .fy = COORD_FROM_DOUBLE(fy) };
+
+    move_led(&led, smooth_data(accel[0]), smooth_data(accel[1]));
+    frame_of(&led, out);
+}
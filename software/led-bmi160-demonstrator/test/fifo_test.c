@@ -0,0 +1,196 @@
+// See LICENSE for license details.
+
+// Host test and benchmark of the single-pass FIFO iterator in bmi160.c:
+// parses FIFO dumps (see gen_fifo.py) with bmi160_fifo_next() and with
+// bmi160_extract_accel()/bmi160_extract_gyro(), checks that both find
+// the same frames, sensortime and skip count, and prints the time each
+// takes per dump.
+//
+//   fifo_test [iterations]
+
+#include "bmi160.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MAX_FRAMES 255
+
+struct dump {
+    const char *path;
+    uint8_t header_enable;
+    uint8_t data_enable;
+};
+
+static const struct dump dumps[] = {
+    { "data/fifo_header.hex", BMI160_FIFO_HEAD_ENABLE, BMI160_FIFO_G_A_ENABLE },
+    { "data/fifo_headerless.hex", 0, BMI160_FIFO_G_A_ENABLE },
+};
+
+struct frames {
+    struct bmi160_sensor_data accel[MAX_FRAMES], gyro[MAX_FRAMES];
+    uint8_t accel_len, gyro_len;
+    uint32_t sensor_time;
+    uint8_t skipped_frame_count;
+};
+
+static uint8_t buf[1024];
+static struct bmi160_fifo_frame fifo;
+static struct bmi160_dev dev = { .fifo = &fifo };
+
+static int load(const struct dump *d)
+{
+    FILE *f = fopen(d->path, "r");
+    char line[128];
+    uint16_t len = 0;
+
+    if (!f) {
+        perror(d->path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), f)) {
+        const char *p = line;
+        unsigned byte;
+        int n;
+
+        if (line[0] == '#') {
+            continue;
+        }
+        while (len < sizeof(buf) && sscanf(p, "%x%n", &byte, &n) == 1) {
+            buf[len++] = (uint8_t)byte;
+            p += n;
+        }
+    }
+    fclose(f);
+    fifo.data = buf;
+    fifo.length = len;
+    fifo.fifo_header_enable = d->header_enable;
+    fifo.fifo_data_enable = d->data_enable;
+    return 0;
+}
+
+/* what bmi160_get_fifo_data() resets before the extract functions run */
+static void rewind_fifo(void)
+{
+    fifo.accel_byte_start_idx = 0;
+    fifo.gyro_byte_start_idx = 0;
+    fifo.aux_byte_start_idx = 0;
+    fifo.sensor_time = 0;
+    fifo.skipped_frame_count = 0;
+}
+
+static void parse_iter(struct frames *out)
+{
+    struct bmi160_fifo_iter iter;
+    struct bmi160_fifo_view view;
+
+    out->accel_len = out->gyro_len = 0;
+    out->sensor_time = 0;
+    out->skipped_frame_count = 0;
+    bmi160_fifo_iter_init(&iter, &dev);
+    while (bmi160_fifo_next(&iter, &view) == BMI160_OK) {
+        switch (view.kind) {
+        case BMI160_FIFO_FRAME_DATA:
+            if (view.accel && out->accel_len < MAX_FRAMES) {
+                bmi160_fifo_unpack_xyz(view.accel, &out->accel[out->accel_len++]);
+            }
+            if (view.gyro && out->gyro_len < MAX_FRAMES) {
+                bmi160_fifo_unpack_xyz(view.gyro, &out->gyro[out->gyro_len++]);
+            }
+            break;
+        case BMI160_FIFO_FRAME_SENSORTIME:
+            out->sensor_time = view.sensor_time;
+            break;
+        case BMI160_FIFO_FRAME_SKIP:
+            out->skipped_frame_count = view.skipped_frame_count;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+static void parse_extract(struct frames *out)
+{
+    rewind_fifo();
+    out->accel_len = MAX_FRAMES;
+    bmi160_extract_accel(out->accel, &out->accel_len, &dev);
+    out->gyro_len = MAX_FRAMES;
+    bmi160_extract_gyro(out->gyro, &out->gyro_len, &dev);
+    out->sensor_time = fifo.sensor_time;
+    out->skipped_frame_count = fifo.skipped_frame_count;
+}
+
+static int same_xyz(const struct bmi160_sensor_data *a, const struct bmi160_sensor_data *b,
+                    int n, const char *what, const char *path)
+{
+    for (int i = 0; i < n; i++) {
+        if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].z != b[i].z) {
+            printf("FAIL: %s: %s frame %d: %d %d %d != %d %d %d\n", path, what, i,
+                   a[i].x, a[i].y, a[i].z, b[i].x, b[i].y, b[i].z);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static double ns_per_call(void (*parse)(struct frames *), struct frames *out, long iterations)
+{
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iterations; i++) {
+        parse(out);
+        __asm__ __volatile__ ("" ::: "memory");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / iterations;
+}
+
+int main(int argc, char **argv)
+{
+    static struct frames iter, extract;
+    long iterations = argc > 1 ? atol(argv[1]) : 20000;
+    int failures = 0;
+
+    for (unsigned i = 0; i < sizeof(dumps) / sizeof(dumps[0]); i++) {
+        const struct dump *d = &dumps[i];
+        double iter_ns, extract_ns;
+
+        if (load(d)) {
+            return 1;
+        }
+        parse_iter(&iter);
+        parse_extract(&extract);
+
+        if (iter.accel_len != extract.accel_len || iter.gyro_len != extract.gyro_len) {
+            printf("FAIL: %s: %u accel %u gyro frames, extract found %u and %u\n", d->path,
+                   iter.accel_len, iter.gyro_len, extract.accel_len, extract.gyro_len);
+            failures++;
+        } else if (!iter.accel_len || !iter.gyro_len) {
+            printf("FAIL: %s: no frames\n", d->path);
+            failures++;
+        } else {
+            failures += !same_xyz(iter.accel, extract.accel, iter.accel_len, "accel", d->path);
+            failures += !same_xyz(iter.gyro, extract.gyro, iter.gyro_len, "gyro", d->path);
+        }
+        if (iter.sensor_time != extract.sensor_time ||
+            iter.skipped_frame_count != extract.skipped_frame_count) {
+            printf("FAIL: %s: sensortime %lu skipped %u, extract %lu and %u\n", d->path,
+                   (unsigned long)iter.sensor_time, iter.skipped_frame_count,
+                   (unsigned long)extract.sensor_time, extract.skipped_frame_count);
+            failures++;
+        }
+
+        iter_ns = ns_per_call(parse_iter, &iter, iterations);
+        extract_ns = ns_per_call(parse_extract, &extract, iterations);
+        printf("%-26s %3u accel %3u gyro frames, iterator %7.0f ns, extract %7.0f ns\n",
+               d->path, iter.accel_len, iter.gyro_len, iter_ns, extract_ns);
+    }
+
+    if (failures) {
+        printf("fifo_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("fifo_test: ok\n");
+    return 0;
+}
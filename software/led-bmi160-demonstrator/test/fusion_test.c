@@ -0,0 +1,131 @@
+// See LICENSE for license details.
+
+// Host test of fusion.c: replays an IMU stream (see gen_imu.py for the
+// format) through fusion_update() and checks roll and pitch against a
+// double precision model of the same filter and, where the stream has
+// them, against the true angles.
+//
+//   fusion_test [stream]    default data/imu_tilt.txt
+
+#include "fusion.h"
+#include <math.h>
+#include <stdio.h>
+
+#define GYRO_RANGE_DPS 2000
+#define ALPHA_Q16 64225         /* 0.98, as in demo.c */
+
+/* the fixed point filter against the double model, in degrees */
+#define MODEL_TOLERANCE 0.1
+/* the filter against the true tilt, in degrees. Accel noise and the
+ * gyro bias pull it off by a tenth or so. */
+#define TRUTH_TOLERANCE 1.0
+
+#define Q16_TO_DEG(a) ((a) * (180.0 / M_PI) / 65536)
+
+struct model {
+    double roll, pitch;
+    int initialized;
+};
+
+static void model_update(struct model *m, const struct bmi160_sensor_data *a,
+                         const struct bmi160_sensor_data *g, uint32_t dt)
+{
+    double alpha = ALPHA_Q16 / 65536.0;
+    double lsb = GYRO_RANGE_DPS / 32768.0 * M_PI / 180 * dt / FUSION_SENSORTIME_HZ;
+    double acc_roll = atan2(a->y, a->z);
+    double acc_pitch = atan2(-a->x, sqrt((double)a->y * a->y + (double)a->z * a->z));
+
+    if (!m->initialized) {
+        m->roll = acc_roll;
+        m->pitch = acc_pitch;
+        m->initialized = 1;
+        return;
+    }
+    m->roll = alpha * (m->roll + g->x * lsb) + (1 - alpha) * acc_roll;
+    m->pitch = alpha * (m->pitch + g->y * lsb) + (1 - alpha) * acc_pitch;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "data/imu_tilt.txt";
+    FILE *f = fopen(path, "r");
+    fusion_state_t fusion;
+    struct model model = { 0 };
+    double model_err = 0, truth_err = 0, truth_sq = 0;
+    unsigned long samples = 0, truths = 0, last_time = 0;
+    int failures = 0;
+    char line[256];
+
+    if (!f) {
+        perror(path);
+        return 1;
+    }
+    fusion_init(&fusion, GYRO_RANGE_DPS, ALPHA_Q16);
+
+    while (fgets(line, sizeof(line), f)) {
+        struct bmi160_sensor_data accel = { 0 }, gyro = { 0 };
+        unsigned long time;
+        int ax, ay, az, gx, gy, gz;
+        long roll_mdeg, pitch_mdeg;
+        uint32_t dt;
+        int n;
+
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        n = sscanf(line, "%lu %d %d %d %d %d %d %ld %ld", &time,
+                   &ax, &ay, &az, &gx, &gy, &gz, &roll_mdeg, &pitch_mdeg);
+        if (n != 7 && n != 9) {
+            fprintf(stderr, "%s: bad line: %s", path, line);
+            return 1;
+        }
+        accel.x = ax; accel.y = ay; accel.z = az;
+        gyro.x = gx; gyro.y = gy; gyro.z = gz;
+        /* as the demo does it, sensortime wraps at 24 bits */
+        dt = (time - last_time) & 0xffffff;
+        last_time = time;
+
+        fusion_update(&fusion, &accel, &gyro, dt);
+        model_update(&model, &accel, &gyro, dt);
+        samples++;
+
+        double roll = Q16_TO_DEG(fusion.roll), pitch = Q16_TO_DEG(fusion.pitch);
+        double err = fmax(fabs(roll - model.roll * 180 / M_PI),
+                          fabs(pitch - model.pitch * 180 / M_PI));
+        if (err > model_err) {
+            model_err = err;
+        }
+        if (err > MODEL_TOLERANCE) {
+            printf("FAIL: sample %lu: roll %.3f pitch %.3f, model %.3f %.3f\n",
+                   samples, roll, pitch, model.roll * 180 / M_PI,
+                   model.pitch * 180 / M_PI);
+            failures++;
+        }
+
+        if (n == 9) {
+            err = fmax(fabs(roll - roll_mdeg / 1000.0), fabs(pitch - pitch_mdeg / 1000.0));
+            truth_err = fmax(truth_err, err);
+            truth_sq += err * err;
+            truths++;
+            if (err > TRUTH_TOLERANCE) {
+                printf("FAIL: sample %lu: roll %.3f pitch %.3f, true %.3f %.3f\n",
+                       samples, roll, pitch, roll_mdeg / 1000.0, pitch_mdeg / 1000.0);
+                failures++;
+            }
+        }
+    }
+    fclose(f);
+
+    printf("%s: %lu samples, max %.3f deg off the model", path, samples, model_err);
+    if (truths) {
+        printf(", max %.3f rms %.3f deg off the true tilt", truth_err,
+               sqrt(truth_sq / truths));
+    }
+    printf("\n");
+    if (!samples || failures) {
+        printf("fusion_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("fusion_test: ok\n");
+    return 0;
+}
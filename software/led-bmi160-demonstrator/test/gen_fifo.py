@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+# See LICENSE for license details.
+"""Writes the BMI160 FIFO dumps fifo_test parses.
+
+A dump is the 1024 bytes bmi160_get_fifo_data() reads from a full FIFO,
+as hex bytes with '#' comments. Both carry the accel and gyro samples of
+data/imu_tilt.txt with the demo's rates, gyro at 3200 Hz and accel at
+1600 Hz:
+
+fifo_header.hex      header mode: a skip and an input config frame, then
+                     gyro and gyro+accel frames (some with interrupt
+                     tags in the header), a sensortime frame and over
+                     read bytes
+fifo_headerless.hex  header-less mode with gyro+accel frames, ending in
+                     the over read pattern
+
+    ./gen_fifo.py data/imu_tilt.txt data
+"""
+
+import os
+import struct
+import sys
+
+FIFO_SIZE = 1024
+
+
+def samples(path):
+    with open(path) as f:
+        for line in f:
+            if line.startswith('#') or not line.strip():
+                continue
+            v = [int(x) for x in line.split()]
+            yield v[0], v[1:4], v[4:7]
+
+
+def xyz(v):
+    return struct.pack('<hhh', *v)
+
+
+def write_hex(path, comment, data):
+    with open(path, 'w') as f:
+        f.write('# %s\n' % comment)
+        for i in range(0, len(data), 16):
+            f.write(' '.join('%02x' % b for b in data[i:i + 16]) + '\n')
+
+
+def header_mode(stream):
+    data = bytearray([0x40, 0x02, 0x48, 0x00])
+    time = 0
+    for n, (time, accel, gyro) in enumerate(stream):
+        # one sample per 400 Hz line stands in for a pair of gyro frames
+        tag = 0x01 if n % 7 == 3 else 0
+        frames = bytes([0x88 | tag]) + xyz(gyro) + bytes([0x8c]) + xyz(gyro) + xyz(accel)
+        if len(data) + len(frames) + 4 > FIFO_SIZE:
+            break
+        data += frames
+    data += bytes([0x44]) + struct.pack('<I', time)[:3]
+    while len(data) < FIFO_SIZE:
+        data += bytes([0x80, 0x00])
+    return data[:FIFO_SIZE]
+
+
+def headerless_mode(stream):
+    data = bytearray()
+    for _, accel, gyro in stream:
+        frame = xyz(gyro) + xyz(accel)
+        if len(data) + len(frame) > FIFO_SIZE - 2:
+            break
+        data += frame
+    while len(data) < FIFO_SIZE:
+        data += bytes([0x80, 0x00])
+    return data[:FIFO_SIZE]
+
+
+def main():
+    src, out = sys.argv[1], sys.argv[2]
+    stream = list(samples(src))
+    # from the roll, so the values move
+    stream = stream[200:]
+    write_hex(os.path.join(out, 'fifo_header.hex'),
+              'gen_fifo.py: header mode, gyro 3200 Hz, accel 1600 Hz',
+              header_mode(stream))
+    write_hex(os.path.join(out, 'fifo_headerless.hex'),
+              'gen_fifo.py: header-less mode, gyro and accel',
+              headerless_mode(stream))
+
+
+if __name__ == '__main__':
+    main()
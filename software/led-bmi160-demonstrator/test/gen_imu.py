@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+# See LICENSE for license details.
+"""Writes an IMU stream in the format fusion_test replays.
+
+One sample per line, whitespace separated:
+
+    sensortime ax ay az gx gy gz [roll_mdeg pitch_mdeg]
+
+sensortime is the 24 bit BMI160 counter (25600 Hz), accel is raw LSB at
+the 2g range and gyro raw LSB at 2000 dps, as the demo configures the
+sensor. The optional last two columns are the true tilt in millidegrees.
+Lines starting with '#' are comments.
+
+The stream is a board tilted by hand: at rest, rolled to 50 degrees at
+100 dps and back, then pitched to -30 degrees at 50 dps and back, with
+sensor noise, a gyro bias and the sensortime counter wrapping. A capture
+from a board in the same format, without the truth columns, replays the
+same way.
+"""
+
+import math
+import random
+import sys
+
+RATE = 400
+TICKS = 25600 // RATE
+ACCEL_LSB_PER_G = 16384
+GYRO_LSB_PER_DPS = 32768 / 2000
+
+# (seconds, roll dps, pitch dps)
+PROFILE = [
+    (0.5, 0, 0),
+    (0.5, 100, 0),
+    (0.5, 0, 0),
+    (0.5, -100, 0),
+    (0.5, 0, 0),
+    (0.6, 0, -50),
+    (0.5, 0, 0),
+    (0.6, 0, 50),
+    (0.4, 0, 0),
+]
+
+
+def main():
+    rng = random.Random(160)
+    out = sys.stdout
+    out.write('# gen_imu.py: %d Hz, roll to 50 deg and back, pitch to -30 deg'
+              ' and back\n' % RATE)
+    t = 0xffffff - 40 * TICKS
+    roll = pitch = 0.0
+    for seconds, roll_dps, pitch_dps in PROFILE:
+        for _ in range(int(seconds * RATE)):
+            roll += roll_dps / RATE
+            pitch += pitch_dps / RATE
+            r, p = math.radians(roll), math.radians(pitch)
+            accel = (-math.sin(p), math.sin(r) * math.cos(p),
+                     math.cos(r) * math.cos(p))
+            gyro = (roll_dps, pitch_dps, 0)
+            a = [round(v * ACCEL_LSB_PER_G + rng.gauss(0, 40)) for v in accel]
+            g = [round(v * GYRO_LSB_PER_DPS + 3 + rng.gauss(0, 2)) for v in gyro]
+            t = (t + TICKS) & 0xffffff
+            out.write('%d %d %d %d %d %d %d %d %d\n' % (
+                t, a[0], a[1], a[2], g[0], g[1], g[2],
+                round(roll * 1000), round(pitch * 1000)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,224 @@
+// See LICENSE for license details.
+
+// Bandwidth and load latency of the memory regions of the linker script.
+//
+// "text" is a buffer linked with the code, so it sits in the flash
+// region: SPI flash XIP on the HiFive1 and the Arty boards, the ITIM
+// with tim-split.lds, and the RAM itself with tim.lds and
+// scratchpad.lds. It is read-only. "data" is a buffer in .bss, in the
+// DTIM or scratchpad RAM.
+//
+// The STREAM kernels run on 32 bit words, these cores have no FPU.
+// copy, scale, add and triad need a writable region, read (a sum) runs
+// on both. The latency chase does one dependent load per step through
+// a working set at a given stride:
+//
+//   p = (p + stride) + *p
+//
+// The buffers are all zero, so this works in read-only memory. Only the
+// add after each load is on the critical path as well. The results are
+// bench records (sifive/bench.h) with bytes_per_cycle and
+// cycles_per_load, each the best of REPS runs after a warmup run.
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sifive/bench.h"
+#include "sifive/bsp_printf.h"
+
+#ifndef MEMBENCH_BYTES
+#define MEMBENCH_BYTES 8192
+#endif
+
+#define WORDS (MEMBENCH_BYTES / sizeof(uint32_t))
+#define REPS 5
+#define SCALAR 3
+#define CHASE_LOADS 4096
+
+static const uint32_t text_buf[WORDS]
+  __attribute__((section(".text.membench"), aligned(64)));
+static uint32_t data_buf[WORDS] __attribute__((aligned(64)));
+
+static volatile uintptr_t sink;
+
+struct region {
+  const char *name;
+  const uint32_t *buf;
+  int writable;
+};
+
+struct kernel {
+  const char *name;
+  void (*fn)(uint32_t *a, uint32_t *b, uint32_t *c, size_t n);
+  size_t bytes;           /* moved per element */
+  int writes;
+};
+
+static void k_read(uint32_t *a, uint32_t *b, uint32_t *c, size_t n)
+{
+  uint32_t sum = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    sum += a[i];
+  }
+  sink = sum;
+}
+
+static void k_copy(uint32_t *a, uint32_t *b, uint32_t *c, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    c[i] = a[i];
+  }
+}
+
+static void k_scale(uint32_t *a, uint32_t *b, uint32_t *c, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    b[i] = SCALAR * c[i];
+  }
+}
+
+static void k_add(uint32_t *a, uint32_t *b, uint32_t *c, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    c[i] = a[i] + b[i];
+  }
+}
+
+static void k_triad(uint32_t *a, uint32_t *b, uint32_t *c, size_t n)
+{
+  for (size_t i = 0; i < n; i++) {
+    a[i] = b[i] + SCALAR * c[i];
+  }
+}
+
+static const struct kernel kernels[] = {
+  { "read", k_read, 4, 0 },
+  { "copy", k_copy, 8, 1 },
+  { "scale", k_scale, 8, 1 },
+  { "add", k_add, 12, 1 },
+  { "triad", k_triad, 12, 1 },
+};
+
+static uintptr_t chase(uintptr_t base, size_t steps, size_t stride,
+                       size_t rounds)
+{
+  uintptr_t p = base;
+
+  while (rounds--) {
+    p = base;
+    /* steps is a multiple of 4 */
+    for (size_t i = 0; i < steps; i += 4) {
+      p = (p + stride) + *(const volatile uint32_t *)p;
+      p = (p + stride) + *(const volatile uint32_t *)p;
+      p = (p + stride) + *(const volatile uint32_t *)p;
+      p = (p + stride) + *(const volatile uint32_t *)p;
+    }
+  }
+  return p;
+}
+
+static void record_case(const char *region, const char *what, uint32_t addr)
+{
+  char name[48];
+
+  bsp_snprintf(name, sizeof(name), "membench_%s_%s", region, what);
+  bench_record_begin(name);
+  bench_record_str("region", region);
+  bench_record_u64("addr", addr);
+}
+
+static void run_kernel(const struct region *r, const struct kernel *k)
+{
+  /* a, b and c split the buffer, read scans all of it */
+  uint32_t *base = (uint32_t *)r->buf;
+  size_t n = k->writes ? WORDS / 3 : WORDS;
+  uint64_t best = UINT64_MAX, instret = 0;
+
+  /* the compiler must not know the text buffer is all zero */
+  __asm__ ("" : "+r" (base));
+  for (int rep = 0; rep <= REPS; rep++) {
+    uint64_t c0, i0, c, i;
+
+    i0 = bench_instret();
+    c0 = bench_cycles();
+    k->fn(base, base + n, base + 2 * n, n);
+    c = bench_cycles() - c0;
+    i = bench_instret() - i0;
+    if (rep > 0 && c < best) {
+      best = c;
+      instret = i;
+    }
+  }
+
+  record_case(r->name, k->name, (uint32_t)(uintptr_t)base);
+  bench_record_u64("bytes", n * k->bytes);
+  bench_record_u64("cycles", best);
+  bench_record_u64("instret", instret);
+  bench_record_fixed("bytes_per_cycle", n * k->bytes * 1000 / best, 3);
+  bench_record_end();
+}
+
+static void run_chase(const struct region *r, size_t ws, size_t stride)
+{
+  uintptr_t base = (uintptr_t)r->buf;
+  size_t steps = ws / stride;
+  size_t rounds = CHASE_LOADS / steps;
+  uint64_t best = UINT64_MAX, instret = 0;
+  char what[32];
+
+  __asm__ ("" : "+r" (base));
+  for (int rep = 0; rep <= REPS; rep++) {
+    uint64_t c0, i0, c, i;
+
+    i0 = bench_instret();
+    c0 = bench_cycles();
+    sink = chase(base, steps, stride, rounds);
+    c = bench_cycles() - c0;
+    i = bench_instret() - i0;
+    if (rep > 0 && c < best) {
+      best = c;
+      instret = i;
+    }
+  }
+
+  bsp_snprintf(what, sizeof(what), "chase_%u_%u", (unsigned)ws,
+               (unsigned)stride);
+  record_case(r->name, what, (uint32_t)base);
+  bench_record_u64("working_set", ws);
+  bench_record_u64("stride", stride);
+  bench_record_u64("loads", steps * rounds);
+  bench_record_u64("cycles", best);
+  bench_record_u64("instret", instret);
+  bench_record_fixed("cycles_per_load", best * 1000 / (steps * rounds), 3);
+  bench_record_end();
+}
+
+int main()
+{
+  static const struct region regions[] = {
+    { "text", text_buf, 0 },
+    { "data", data_buf, 1 },
+  };
+  static const size_t strides[] = { 4, 16, 64, 256 };
+
+  for (unsigned i = 0; i < sizeof(regions) / sizeof(regions[0]); i++) {
+    const struct region *r = &regions[i];
+
+    for (unsigned k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+      if (r->writable || !kernels[k].writes) {
+        run_kernel(r, &kernels[k]);
+      }
+    }
+    for (size_t ws = 1024; ws <= MEMBENCH_BYTES; ws *= 2) {
+      for (unsigned s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+        /* at least 4 steps per round, see chase() */
+        if (strides[s] * 4 <= ws) {
+          run_chase(r, ws, strides[s]);
+        }
+      }
+    }
+  }
+
+  bench_end();
+  return 0;
+}
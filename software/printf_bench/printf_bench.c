@@ -0,0 +1,125 @@
+// See LICENSE for license details.
+
+// Compares bsp_snprintf() from libwrap with newlib-nano's snprintf()
+// in mcycles per output character. Both write into a RAM buffer so
+// the UART does not show up in the numbers.
+//
+// PRINTF_IMPL in the Makefile picks the formatters linked in. Builds
+// with only one of them (or none) print the formatted strings instead,
+// they exist to compare the flash footprint, see printf_footprint in
+// the top level Makefile.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "encoding.h"
+#include "sifive/bsp_printf.h"
+
+#ifdef BENCH_NEWLIB
+asm (".global _printf_float");
+#endif
+
+#define ITERATIONS 100
+
+struct bench {
+  const char *name;
+  int (*bsp)(char *buf, size_t size);
+  int (*newlib)(char *buf, size_t size);
+};
+
+#ifdef BENCH_BSP
+#define BENCH_BSP_FN(name, ...)                                   \
+  static int name##_bsp(char *buf, size_t size)                   \
+  {                                                               \
+    return bsp_snprintf(buf, size, __VA_ARGS__);                  \
+  }
+#define BSP(name) name##_bsp
+#else
+#define BENCH_BSP_FN(name, ...)
+#define BSP(name) NULL
+#endif
+
+#ifdef BENCH_NEWLIB
+#define BENCH_NEWLIB_FN(name, ...)                                \
+  static int name##_newlib(char *buf, size_t size)                \
+  {                                                               \
+    return snprintf(buf, size, __VA_ARGS__);                      \
+  }
+#define NEWLIB(name) name##_newlib
+#else
+#define BENCH_NEWLIB_FN(name, ...)
+#define NEWLIB(name) NULL
+#endif
+
+#define BENCH(name, ...)                                          \
+  BENCH_BSP_FN(name, __VA_ARGS__)                                 \
+  BENCH_NEWLIB_FN(name, __VA_ARGS__)
+
+// No %llu: newlib-nano's formatter has no long long support
+BENCH(string, "%s: %s", "CoreMark Size", "666")
+BENCH(decimal, "%d %u %ld", -123456, 4000000000u, 987654321L)
+BENCH(padded, "%-8s %3u.%u%% runs %5u misses %u", "render", 12u, 5u, 600u, 0u)
+BENCH(hex, "0x%08lx 0x%x %p", 0xdeadbeefUL, 0x1f, (void *)0x80000000)
+BENCH(fixed, "%6.1f %.3f", 1234.56, -0.125)
+
+static const struct bench benches[] = {
+  { "string", BSP(string), NEWLIB(string) },
+  { "decimal", BSP(decimal), NEWLIB(decimal) },
+  { "padded", BSP(padded), NEWLIB(padded) },
+  { "hex", BSP(hex), NEWLIB(hex) },
+  { "fixed", BSP(fixed), NEWLIB(fixed) },
+};
+
+#define NUM_BENCHES (sizeof(benches) / sizeof(benches[0]))
+
+#if defined(BENCH_BSP) && defined(BENCH_NEWLIB)
+static uint32_t cycles_per_char(int (*fn)(char *, size_t))
+{
+  char buf[64];
+  uint32_t start, cycles;
+  int len = 0;
+
+  fn(buf, sizeof(buf));
+  start = read_csr(mcycle);
+  for (int i = 0; i < ITERATIONS; i++) {
+    len = fn(buf, sizeof(buf));
+  }
+  cycles = read_csr(mcycle) - start;
+  return len ? cycles / (ITERATIONS * (uint32_t)len) : 0;
+}
+
+int main()
+{
+  bsp_printf("%-8s %10s %10s\n", "format", "bsp c/ch", "nano c/ch");
+  for (unsigned i = 0; i < NUM_BENCHES; i++) {
+    const struct bench *b = &benches[i];
+
+    bsp_printf("%-8s %10lu %10lu\n", b->name,
+               (unsigned long)cycles_per_char(b->bsp),
+               (unsigned long)cycles_per_char(b->newlib));
+  }
+
+  return 0;
+}
+#else
+int main()
+{
+  for (unsigned i = 0; i < NUM_BENCHES; i++) {
+    int (*fn)(char *, size_t) = benches[i].bsp ? benches[i].bsp : benches[i].newlib;
+    char buf[64];
+    int len;
+
+    if (!fn) {
+      break;
+    }
+    len = fn(buf, sizeof(buf) - 1);
+    if (len > (int)sizeof(buf) - 2) {
+      len = sizeof(buf) - 2;
+    }
+    buf[len++] = '\n';
+    write(STDOUT_FILENO, buf, len);
+  }
+
+  return 0;
+}
+#endif
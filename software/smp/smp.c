@@ -1,36 +1,28 @@
 #include <stdio.h>
 #include <unistd.h>
-#include "atomic.h"
+#include "sifive/smp.h"
 void write_hex(int, unsigned long);
 
-atomic_t tty_lock = ATOMIC_INIT(0);
-
-void get_lock(atomic_t *lock)
-{
-  while (atomic_xchg(lock, 1) == 1);
-  mb();
-}
-
-void put_lock(atomic_t *lock)
-{
-  mb();
-  atomic_xchg(lock, 0);
-}
+/* every hart counts in its own TLS block */
+static __thread unsigned long greetings;
 
 int secondary_main(int hartid)
 {
   volatile int counter;
 
   while (1) {
-    get_lock(&tty_lock);
+    /* libwrap buffers per hart and writes out whole lines */
     write(1, "hello world from hart ", 22);
-    char s[] = {'0', '\n', '\0'};
+    char s[] = {'0', ' ', '\0'};
     s[0] += hartid;
     write(1, s, 2);
-    put_lock(&tty_lock);
+    write_hex(1, ++greetings);
+    if (!hart_stack_intact(hartid))
+      write(1, " stack overflow", 15);
+    write(1, "\n", 1);
 
     for (counter = 0; counter < 10000 + 100*hartid; ++counter)
-        mb();
+        ;
   }
 }
 
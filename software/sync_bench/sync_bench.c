@@ -0,0 +1,131 @@
+// See LICENSE for license details.
+
+// Lock contention benchmark. For every hart count from 1 up to the
+// number of harts that came up (at most SMP_HARTS) each participating
+// hart takes and releases every lock kind ITERATIONS times around a
+// shared counter increment. Hart 0 prints the mcycles per acquisition.
+
+#include <stdio.h>
+#include <stdint.h>
+#include "platform.h"
+#include "encoding.h"
+#include "sifive/smp.h"
+#include "sifive/sync.h"
+
+#define ITERATIONS 1000
+
+enum { LOCK_TAS, LOCK_TTAS, LOCK_TICKET, LOCK_MCS, NUM_LOCKS };
+
+static const char *lock_names[NUM_LOCKS] = { "tas", "ttas", "ticket", "mcs" };
+
+static volatile uint32_t tas_lock;
+static spinlock_t spin = SPINLOCK_INIT;
+static ticketlock_t ticket = TICKETLOCK_INIT;
+static mcslock_t mcs = MCSLOCK_INIT;
+
+static volatile uint32_t counter;
+/* the lock get_lock() in software/smp used: amoswap in a tight loop */
+static void tas_acquire(void)
+{
+  uint32_t old;
+
+  do {
+    __asm__ __volatile__ (
+      "amoswap.w.aq %0, %2, %1"
+      : "=r" (old), "+A" (tas_lock)
+      : "r" (1)
+      : "memory");
+  } while (old);
+}
+
+static void tas_release(void)
+{
+  __asm__ __volatile__ (
+    "amoswap.w.rl zero, zero, %0"
+    : "+A" (tas_lock)
+    :
+    : "memory");
+}
+
+static void run(int kind)
+{
+  mcsnode_t node;
+
+  for (int i = 0; i < ITERATIONS; i++) {
+    switch (kind) {
+    case LOCK_TAS:
+      tas_acquire();
+      counter++;
+      tas_release();
+      break;
+    case LOCK_TTAS:
+      spin_lock(&spin);
+      counter++;
+      spin_unlock(&spin);
+      break;
+    case LOCK_TICKET:
+      ticket_lock(&ticket);
+      counter++;
+      ticket_unlock(&ticket);
+      break;
+    case LOCK_MCS:
+      mcs_lock(&mcs, &node);
+      counter++;
+      mcs_unlock(&mcs, &node);
+      break;
+    }
+  }
+}
+
+static void bench(int hartid)
+{
+  uint32_t num_harts = smp_harts();
+
+  if (hartid == 0) {
+    printf("%u harts, %u acquisitions per hart\n",
+           (unsigned)num_harts, ITERATIONS);
+    printf("harts   %8s %8s %8s %8s   (cycles/acquisition)\n",
+           lock_names[0], lock_names[1], lock_names[2], lock_names[3]);
+  }
+
+  for (uint32_t n = 1; n <= num_harts; n++) {
+    uint32_t cycles[NUM_LOCKS];
+
+    for (int kind = 0; kind < NUM_LOCKS; kind++) {
+      uint32_t start;
+
+      if (hartid == 0) {
+        counter = 0;
+      }
+      smp_barrier();
+      start = read_csr(mcycle);
+      if ((uint32_t)hartid < n) {
+        run(kind);
+      }
+      smp_barrier();
+      cycles[kind] = (read_csr(mcycle) - start) / (n * ITERATIONS);
+      if (hartid == 0 && counter != n * ITERATIONS) {
+        printf("%s: lost updates, %u of %u\n", lock_names[kind],
+               (unsigned)counter, (unsigned)(n * ITERATIONS));
+      }
+    }
+    if (hartid == 0) {
+      printf("%5u   %8u %8u %8u %8u\n", (unsigned)n, (unsigned)cycles[0],
+             (unsigned)cycles[1], (unsigned)cycles[2], (unsigned)cycles[3]);
+    }
+  }
+}
+
+int secondary_main(int hartid)
+{
+  bench(hartid);
+  while (1) {
+    __asm__ __volatile__ ("wfi");
+  }
+}
+
+int main()
+{
+  bench(0);
+  return 0;
+}
@@ -0,0 +1,109 @@
+// See LICENSE for license details.
+
+// Speedup of the work-stealing runtime (sifive/task.h) on a
+// CoreMark-like kernel: every block multiplies two generated 8x8
+// int16 matrices and folds the products into a CRC-16, blocks are
+// spread over the harts with task_parallel_for(). The kernel runs
+// once plainly on hart 0 for reference, then with 1, 2, ... harts.
+// The combined CRC has to match the reference in every run.
+
+#include <stdio.h>
+#include <stdint.h>
+#include "encoding.h"
+#include "sifive/task.h"
+
+#define BLOCKS 256
+#define GRAIN 4
+#define N 8
+
+static uint16_t block_crc[BLOCKS];
+
+static uint16_t crc16(uint16_t crc, uint16_t v)
+{
+  for (int i = 0; i < 16; i++) {
+    int x = (crc ^ v) & 1;
+
+    v >>= 1;
+    crc >>= 1;
+    if (x) {
+      crc ^= 0xa001;
+    }
+  }
+  return crc;
+}
+
+static uint16_t block(int seed)
+{
+  uint16_t crc = 0;
+
+  /* generate the operands instead of storing them, the secondary
+   * harts only have small stacks */
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      int32_t acc = 0;
+
+      for (int k = 0; k < N; k++) {
+        int16_t a = (int16_t)((seed + i * N + k) * 0x9e37);
+        int16_t b = (int16_t)((seed ^ (k * N + j)) * 0x7f4b);
+
+        acc += a * b;
+      }
+      crc = crc16(crc, (uint16_t)(acc >> 8));
+    }
+  }
+  return crc;
+}
+
+static void blocks(int lo, int hi, void *arg)
+{
+  for (int i = lo; i < hi; i++) {
+    block_crc[i] = block(i);
+  }
+}
+
+static uint16_t combine(void)
+{
+  uint16_t crc = 0;
+
+  for (int i = 0; i < BLOCKS; i++) {
+    crc = crc16(crc, block_crc[i]);
+  }
+  return crc;
+}
+
+int secondary_main(int hartid)
+{
+  task_worker(hartid);
+}
+
+int main()
+{
+  int harts = task_init();
+  uint32_t start, serial;
+  uint16_t ref;
+
+  printf("%d harts, %d blocks, grain %d\n", harts, BLOCKS, GRAIN);
+
+  start = read_csr(mcycle);
+  blocks(0, BLOCKS, NULL);
+  serial = read_csr(mcycle) - start;
+  ref = combine();
+  printf("serial  %10u cycles  crc %04x\n", (unsigned)serial, ref);
+
+  for (int n = 1; n <= harts; n++) {
+    uint32_t cycles;
+
+    for (int i = 0; i < BLOCKS; i++) {
+      block_crc[i] = 0;
+    }
+    task_set_harts(n);
+    start = read_csr(mcycle);
+    task_parallel_for(0, BLOCKS, GRAIN, blocks, NULL);
+    cycles = read_csr(mcycle) - start;
+    printf("%d harts %10u cycles  speedup %u.%02u%s\n", n, (unsigned)cycles,
+           (unsigned)(serial / cycles),
+           (unsigned)(serial * 100ull / cycles % 100),
+           combine() == ref ? "" : "  CRC MISMATCH");
+  }
+  return 0;
+}
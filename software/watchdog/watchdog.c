@@ -8,6 +8,7 @@
 #include "encoding.h"
 #include <unistd.h>
 #include "stdatomic.h"
+#include "sifive/trace.h"
 
 void reset_demo (void);
 
@@ -75,8 +76,9 @@ void handle_m_time_interrupt(){
   //flash a led
   GPIO_REG(GPIO_OUTPUT_VAL) ^=	(0x1 << BLUE_LED_OFFSET);
   
-  //print the count
-  printf("watchdog reset in %d\n", countdown--);
+  //log the count, printed from the main loop
+  TRACE("watchdog reset in %d\n", countdown);
+  countdown--;
 }
 
 
@@ -200,6 +202,7 @@ int main(int argc, char **argv)
  
   while (1){
     char c;
+    trace_drain();
     if(((int32_t) UART0_REG(UART_REG_RXFIFO)) > 0){
         //flash green led to indicate Kick
         GPIO_REG(GPIO_OUTPUT_VAL)  &=   ~(0x1 << GREEN_LED_OFFSET) ;  